@@ -0,0 +1,437 @@
+/**************************************************************************************************
+*
+* \file benchmark.h
+* \brief C++ Training - Self-contained micro benchmark harness
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* This header provides the subset of the Google Benchmark interface that is used throughout the
+* training ('benchmark::State', 'BENCHMARK()', 'DoNotOptimize()', 'ClobberMemory()', ...). Thus
+* all benchmarks can be built without any external dependency, but can still be copy-and-pasted
+* into 'quick-bench.com' without modification.
+*
+**************************************************************************************************/
+
+#ifndef BENCHMARK_BENCHMARK_H
+#define BENCHMARK_BENCHMARK_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace benchmark {
+
+class State;
+
+namespace internal {
+class Benchmark;
+class BenchmarkRunner;
+class PerfCounters;
+class ThreadBarrier;
+} // namespace internal
+
+
+//---- Optimization barriers ----------------------------------------------------------------------
+
+#if defined(__GNUC__) || defined(__clang__)
+
+// Forces the compiler to assume that the given value is read (and potentially modified), i.e.
+// prevents the computation of the value from being optimized away.
+template< typename T >
+inline void DoNotOptimize( T const& value )
+{
+   asm volatile( "" : : "r,m"(value) : "memory" );
+}
+
+template< typename T >
+inline void DoNotOptimize( T& value )
+{
+   if constexpr( std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(void*) ) {
+      asm volatile( "" : "+m,r"(value) : : "memory" );
+   }
+   else {
+      asm volatile( "" : "+m"(value) : : "memory" );
+   }
+}
+
+// Forces the compiler to perform all pending writes to global memory.
+inline void ClobberMemory()
+{
+   asm volatile( "" : : : "memory" );
+}
+
+#else
+
+namespace internal {
+void useCharPointer( char const volatile* );
+} // namespace internal
+
+template< typename T >
+inline void DoNotOptimize( T const& value )
+{
+   internal::useCharPointer( &reinterpret_cast<char const volatile&>( value ) );
+}
+
+inline void ClobberMemory()
+{
+   std::atomic_signal_fence( std::memory_order_acq_rel );
+}
+
+#endif
+
+
+//---- <TimeUnit> ---------------------------------------------------------------------------------
+
+enum TimeUnit { kNanosecond, kMicrosecond, kMillisecond, kSecond };
+
+
+//---- Allocation tracking ----------------------------------------------------------------------
+
+struct AllocationCounts
+{
+   int64_t allocations{};
+   int64_t deallocations{};
+   int64_t bytes{};
+   int64_t peakBytes{};  // Heap high-water mark relative to the start of the tracking
+};
+
+// Starts counting all heap allocations performed via the global operator new (in all threads).
+void StartAllocationTracking();
+
+// Stops counting and returns the number of allocations, deallocations and allocated bytes, and
+// the maximum number of simultaneously allocated bytes. Since the size of a deallocated block is
+// determined via 'malloc_usable_size()', the high-water mark is only available with glibc.
+AllocationCounts StopAllocationTracking();
+
+
+//---- Heap statistics ----------------------------------------------------------------------------
+
+struct HeapStatistics
+{
+   int64_t arena{};       // Bytes obtained from the system for the heap (excluding mmap'ed blocks)
+   int64_t inUse{};       // Bytes in allocated chunks
+   int64_t free{};        // Bytes in free chunks (including the releasable top chunk)
+   int64_t releasable{};  // Bytes at the top of the heap that could be returned via 'malloc_trim()'
+   int64_t mmapped{};     // Bytes in blocks allocated directly via mmap
+   int64_t freeChunks{};  // Number of free chunks
+   int64_t arenas{};      // Number of malloc arenas
+
+   // Returns the fraction of the heap that is free but cannot be returned to the system, i.e. the
+   // free memory trapped between allocated chunks.
+   double fragmentation() const
+   {
+      return arena > 0 ? static_cast<double>( free - releasable ) / static_cast<double>( arena ) : 0.0;
+   }
+};
+
+// Returns the current state of the heap of the process (via 'mallinfo2()' and 'malloc_info()').
+// The statistics are only available with glibc; otherwise all values are zero.
+HeapStatistics GetHeapStatistics();
+
+
+//---- <LatencyHistogram> -------------------------------------------------------------------------
+
+// Histogram of latencies in nanoseconds with logarithmic buckets (in the style of HdrHistogram).
+// Values below 128ns are recorded exactly; larger values are recorded with a relative precision
+// of 1/64 (i.e. ~1.6%) up to the full range of 'int64_t'.
+class LatencyHistogram
+{
+ public:
+   void record( int64_t nanoseconds );
+   void merge( LatencyHistogram const& other );
+   void reset();
+
+   int64_t count() const { return count_; }
+   int64_t min() const { return count_ > 0 ? min_ : 0; }
+   int64_t max() const { return max_; }
+
+   // Returns the (upper bound of the) value below which the given percentage of all recorded
+   // values lie (e.g. 'percentile( 99.9 )').
+   int64_t percentile( double percent ) const;
+
+ private:
+   std::vector<int64_t> counts_{};
+   int64_t count_{};
+   int64_t min_{};
+   int64_t max_{};
+};
+
+
+//---- <State> ------------------------------------------------------------------------------------
+
+class State
+{
+ public:
+   class StateIterator;
+
+   // Support for the range-based for loop 'for( auto _ : state )'. The timer is started by
+   // 'begin()' and stopped as soon as the requested number of iterations has been executed.
+   StateIterator begin();
+   StateIterator end();
+
+   // Alternative (pre-C++11 style) interface: 'while( state.KeepRunning() )'.
+   bool KeepRunning();
+
+   // Excludes the enclosed code from the measurement (e.g. setup code within the loop).
+   void PauseTiming();
+   void ResumeTiming();
+
+   int64_t iterations() const { return completed_; }
+
+   // Returns the value of the given benchmark argument (see 'Arg()', 'Range()', ...).
+   int64_t range( std::size_t index = 0UL ) const { return args_.at( index ); }
+
+   // Index of the calling thread and total number of threads (see 'Threads()', 'ThreadRange()').
+   int thread_index() const { return threadIndex_; }
+   int threads() const { return threads_; }
+
+   // Measures the latency of the given operation and records it in the latency histogram of the
+   // benchmark, which is reported as 'p50-ns', 'p99-ns', 'p99.9-ns' and 'max-ns'. Note that the
+   // measurement adds the overhead of two clock reads to the runtime of every operation.
+   template< typename Operation >
+   void MeasureLatency( Operation&& operation )
+   {
+      auto const start( std::chrono::steady_clock::now() );
+      std::forward<Operation>( operation )();
+      auto const stop( std::chrono::steady_clock::now() );
+      latencies_.record( std::chrono::duration_cast<std::chrono::nanoseconds>( stop - start ).count() );
+   }
+
+   // Sets the total number of processed elements (e.g. 'state.iterations() * N'). If set, the
+   // hardware counters are reported per element instead of per iteration.
+   void SetItemsProcessed( int64_t items ) { itemsProcessed_ = items; }
+   int64_t items_processed() const { return itemsProcessed_; }
+
+   // Captures the heap statistics at the current point of the benchmark (e.g. before destroying
+   // the data structure of interest), which are reported instead of the statistics captured after
+   // the repetition. Only has an effect in case '--benchmark_heap_stats' is enabled.
+   void RecordHeapStatistics();
+
+   int64_t const max_iterations;
+
+   // User-defined counters (e.g. 'state.counters["copies"] = n;'), which are reported per
+   // repetition. In multi-threaded runs, the counters of all threads are summed up.
+   std::map<std::string,double> counters{};
+
+ private:
+   State( int64_t maxIterations, std::vector<int64_t> args, int threadIndex = 0, int threads = 1,
+          internal::ThreadBarrier* barrier = nullptr );
+
+   void startKeepRunning();
+   void finishKeepRunning();
+
+   double elapsedSeconds() const { return seconds_; }
+
+   uint64_t start_{};
+   double seconds_{};
+   int64_t intervals_{};
+   int64_t completed_{};
+   int64_t itemsProcessed_{};
+   std::vector<int64_t> args_{};
+   int threadIndex_{};
+   int threads_{ 1 };
+   internal::ThreadBarrier* barrier_{ nullptr };
+   internal::PerfCounters* perf_{ nullptr };
+   LatencyHistogram latencies_{};
+   HeapStatistics heapStatistics_{};
+   bool recordHeapStatistics_{ false };
+   bool hasHeapStatistics_{ false };
+   bool started_{ false };
+   bool finished_{ false };
+   bool running_{ false };
+
+   friend class internal::BenchmarkRunner;
+};
+
+
+class State::StateIterator
+{
+ public:
+   struct [[maybe_unused]] Value {};
+
+   StateIterator() = default;
+
+   explicit StateIterator( State* parent )
+      : remaining_{ parent->max_iterations }
+      , parent_   { parent }
+   {}
+
+   Value operator*() const { return Value{}; }
+
+   StateIterator& operator++()
+   {
+      --remaining_;
+      return *this;
+   }
+
+   bool operator!=( StateIterator const& ) const
+   {
+      if( remaining_ > 0 ) [[likely]] {
+         return true;
+      }
+      parent_->finishKeepRunning();
+      return false;
+   }
+
+ private:
+   int64_t remaining_{};
+   State* parent_{ nullptr };
+};
+
+
+inline State::StateIterator State::begin()
+{
+   startKeepRunning();
+   return StateIterator{ this };
+}
+
+inline State::StateIterator State::end()
+{
+   return StateIterator{};
+}
+
+
+//---- <Benchmark> --------------------------------------------------------------------------------
+
+using Function = void( State& );
+
+namespace internal {
+
+class Benchmark
+{
+ public:
+   Benchmark( std::string name, Function* function );
+
+   // Fixes the number of iterations per repetition (default: auto-scaled to the minimum time).
+   Benchmark* Iterations( int64_t iterations );
+
+   // Sets the number of repetitions used to compute the mean/median/stddev (default: 5).
+   Benchmark* Repetitions( int repetitions );
+
+   // Sets the minimum time in seconds a single repetition should take (default: 0.5s).
+   Benchmark* MinTime( double seconds );
+
+   // Sets the minimum time in seconds the benchmark is run before the first measured repetition,
+   // e.g. to warm up caches, branch predictors and the memory allocator (default: 0.1s).
+   Benchmark* MinWarmUpTime( double seconds );
+
+   // Sets the time unit used to report the results (default: automatically chosen).
+   Benchmark* Unit( TimeUnit unit );
+
+   // Adds a run with the given argument(s), accessible via 'state.range(0)', 'state.range(1)', ...
+   Benchmark* Arg( int64_t arg );
+   Benchmark* Args( std::vector<int64_t> const& args );
+
+   // Adds runs for 'lo', all powers of the range multiplier in between and 'hi'.
+   Benchmark* Range( int64_t lo, int64_t hi );
+   Benchmark* Ranges( std::vector< std::pair<int64_t,int64_t> > const& ranges );
+   Benchmark* RangeMultiplier( int multiplier );
+
+   // Adds runs for 'lo', 'lo+step', ... up to 'hi'.
+   Benchmark* DenseRange( int64_t lo, int64_t hi, int64_t step = 1 );
+
+   // Adds runs for the Cartesian product of the given argument lists.
+   Benchmark* ArgsProduct( std::vector< std::vector<int64_t> > const& arglists );
+
+   // Names the arguments in the reported benchmark name (e.g. 'benchmark/N:100/length:32').
+   Benchmark* ArgNames( std::vector<std::string> const& names );
+
+   // Runs the benchmark function concurrently on the given number of threads. Each thread executes
+   // all iterations, i.e. the total amount of work grows with the number of threads.
+   Benchmark* Threads( int threads );
+
+   // Adds runs for 'min', all powers of 2 in between and 'max' threads.
+   Benchmark* ThreadRange( int min, int max );
+
+   // Adds a cold-cache run ('/cache:cold') next to the regular warm-cache run ('/cache:warm'). Before
+   // every repetition of the cold run, the last-level cache is evicted by streaming through a
+   // buffer larger than the cache, and the repetition is limited to a single iteration.
+   Benchmark* CacheModes();
+
+   // Excludes the benchmark from the default run; it is only run if explicitly selected via
+   // '--benchmark_filter' (e.g. for expensive parameter sweeps).
+   Benchmark* ExplicitOnly();
+
+   std::string const& name() const { return name_; }
+   bool explicitOnly() const { return explicitOnly_; }
+
+ private:
+   std::string name_;
+   Function* function_;
+   std::vector< std::vector<int64_t> > args_{};
+   std::vector<std::string> argNames_{};
+   std::vector<int> threads_{};
+   int rangeMultiplier_{ 8 };
+   bool cacheModes_{ false };
+   bool explicitOnly_{ false };
+   int64_t iterations_{};
+   int repetitions_{};
+   double minTime_{};
+   double minWarmUpTime_{ -1.0 };
+   TimeUnit unit_{ kNanosecond };
+   bool hasUnit_{ false };
+
+   friend class BenchmarkRunner;
+};
+
+} // namespace internal
+
+
+internal::Benchmark* RegisterBenchmark( std::string name, Function* function );
+
+// Returns 'lo', all powers of 'multiplier' in between, and 'hi' (e.g. 100, 1000, ..., 10000000).
+std::vector<int64_t> CreateRange( int64_t lo, int64_t hi, int multiplier );
+
+// Returns 'lo', 'lo+step', ... up to and including 'hi'.
+std::vector<int64_t> CreateDenseRange( int64_t lo, int64_t hi, int64_t step );
+
+// Parses and removes all '--benchmark_*' command line arguments.
+void Initialize( int* argc, char** argv );
+
+// Runs all registered benchmarks matching the '--benchmark_filter' and returns their number.
+std::size_t RunSpecifiedBenchmarks();
+
+void Shutdown();
+
+} // namespace benchmark
+
+
+//---- Registration macros ------------------------------------------------------------------------
+
+#define BENCHMARK_PRIVATE_CONCAT2( a, b ) a##b
+#define BENCHMARK_PRIVATE_CONCAT( a, b ) BENCHMARK_PRIVATE_CONCAT2( a, b )
+#define BENCHMARK_PRIVATE_NAME( name ) BENCHMARK_PRIVATE_CONCAT( name, __COUNTER__ )
+
+#define BENCHMARK( function ) \
+   [[maybe_unused]] static ::benchmark::internal::Benchmark* \
+      BENCHMARK_PRIVATE_NAME( benchmark_registration_ ) = \
+         ::benchmark::RegisterBenchmark( #function, function )
+
+// Registers the given instantiation of a function template (e.g. 'BENCHMARK_TEMPLATE(f,int,8)'),
+// named after the template arguments (e.g. 'f<int,8>').
+#define BENCHMARK_TEMPLATE( function, ... ) \
+   [[maybe_unused]] static ::benchmark::internal::Benchmark* \
+      BENCHMARK_PRIVATE_NAME( benchmark_registration_ ) = \
+         ::benchmark::RegisterBenchmark( #function "<" #__VA_ARGS__ ">", function<__VA_ARGS__> )
+
+#define BENCHMARK_MAIN() \
+   int main( int argc, char** argv ) \
+   { \
+      ::benchmark::Initialize( &argc, argv ); \
+      ::benchmark::RunSpecifiedBenchmarks(); \
+      ::benchmark::Shutdown(); \
+      return 0; \
+   } \
+   int main( int, char** )
+
+#endif
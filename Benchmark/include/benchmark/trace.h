@@ -0,0 +1,89 @@
+/**************************************************************************************************
+*
+* \file trace.h
+* \brief C++ Training - Trace recorder for special member function calls
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* The trace recorder logs each construction, assignment and destruction of an object together
+* with the object address, a timestamp and the current call-site tag (see 'trace::Scope'). In
+* addition, the name of each call is echoed to stdout (see 'trace::echo()'). The recorded events
+* are written in the Chrome trace event format, which can be opened in 'chrome://tracing' or
+* 'ui.perfetto.dev': every object lifetime is shown as a bar, every special member function call
+* as an instant event, and every scope as a slice on the calling thread.
+*
+* Recording is enabled by setting the environment variable 'BENCHMARK_TRACE' to the name of the
+* output file (e.g. 'BENCHMARK_TRACE=rvo.json ./RVO3_Trace'); the file is written at program exit.
+* Alternatively, recording can be enabled via 'trace::enable()' and written via 'trace::write()'.
+*
+* Every thread records its events (with a TSC timestamp) into its own lock-free ring buffer, which
+* is drained by a background thread. Thus recording does not serialize the recording threads and
+* can stay enabled in load tests; in case a buffer overflows, the events are dropped (and the
+* number of dropped events is reported). The same applies to the events exceeding the limit of
+* about 4 million recorded events (about 160 MB), which bounds the memory of long recordings. Note that echoing to stdout does serialize all threads
+* and should be disabled via 'trace::echo( false )' for this purpose.
+*
+**************************************************************************************************/
+
+#ifndef BENCHMARK_TRACE_H
+#define BENCHMARK_TRACE_H
+
+#include <string>
+
+
+namespace benchmark {
+
+namespace trace {
+
+// Enables/disables the recording of events (by default only enabled via 'BENCHMARK_TRACE').
+void enable( bool enabled = true );
+bool enabled();
+
+// Enables/disables printing the name of every special member function call to stdout (default:
+// enabled, independent of the recording).
+void echo( bool enabled );
+
+// Records the begin of the lifetime of the given object (called from a constructor).
+void construct( void const* object, char const* function );
+
+// Records an assignment to the given object (called from an assignment operator).
+void assign( void const* object, char const* function );
+
+// Records the end of the lifetime of the given object (called from the destructor).
+void destroy( void const* object, char const* function );
+
+// Records a call of a special member function of the given object without echoing it and returns
+// the given name. The kind of the call is deduced from the name: a leading '~' denotes the
+// destructor, 'operator=' an assignment, anything else a constructor (see <benchmark/trace_puts.h>).
+char const* call( void const* object, char const* function );
+
+// Writes all events recorded so far in the Chrome trace event format; returns 'false' in case
+// the file cannot be written.
+bool write( std::string const& filename );
+
+
+//---- <Scope> ------------------------------------------------------------------------------------
+
+// Tags all events recorded on the calling thread during its lifetime with the given name (e.g.
+// 'trace::Scope const scope{ "f()" };'). Scopes can be nested; the innermost tag is recorded.
+class Scope
+{
+ public:
+   explicit Scope( char const* name );
+   ~Scope();
+
+   Scope( Scope const& ) = delete;
+   Scope& operator=( Scope const& ) = delete;
+
+ private:
+   char const* previous_;
+};
+
+} // namespace trace
+
+} // namespace benchmark
+
+#endif
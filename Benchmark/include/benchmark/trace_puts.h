@@ -0,0 +1,46 @@
+/**************************************************************************************************
+*
+* \file trace_puts.h
+* \brief C++ Training - Tracing of programs that print their special member function calls
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* Records the special member function calls of an unmodified program (see <benchmark/trace.h>),
+* which prints the name of every call via 'std::puts()' from within the special member function:
+*
+*    struct S
+*    {
+*       S() { std::puts( "S()" ); }
+*       ~S() { std::puts( "~S()" ); }
+*    };
+*
+* The header is included in front of the program (e.g. '-include benchmark/trace_puts.h') and
+* turns every such 'puts()' call into a call of 'trace::call()' for the object 'this', which must
+* therefore be available at every call of 'puts()'. All calls are tagged with the scope "main()",
+* which is opened before and closed after the 'main()' function of the program.
+*
+**************************************************************************************************/
+
+#ifndef BENCHMARK_TRACE_PUTS_H
+#define BENCHMARK_TRACE_PUTS_H
+
+#include <benchmark/trace.h>
+#include <cstdio>
+
+namespace benchmark {
+
+namespace trace {
+
+// Opened during the dynamic initialization of the program, i.e. before the call of 'main()'
+inline Scope const mainScope{ "main()" };
+
+} // namespace trace
+
+} // namespace benchmark
+
+#define puts( text ) puts( ::benchmark::trace::call( this, text ) )
+
+#endif
@@ -0,0 +1,274 @@
+/**************************************************************************************************
+*
+* \file traced.h
+* \brief C++ Training - Wrapper type counting the special member function calls of a value
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* 'Traced<T>' wraps a value of type 'T' and counts all default, value, copy and move constructions,
+* all copy and move assignments and all destructions of the wrapper. In contrast to the trace
+* recorder (see <benchmark/trace.h>), nothing is printed or recorded per call; every thread just
+* increments its own counters, which are summed up on demand via 'Traced<T>::counts()'. Thus the
+* wrapper can be used in tight loops and in multi-threaded benchmarks:
+*
+*    struct Widget {
+*       benchmark::Traced<std::string> name;  // Counts the copies and moves of all Widgets
+*    };
+*
+*    benchmark::Traced<std::string>::reset();
+*    ...
+*    benchmark::TracedCounts const counts( benchmark::Traced<std::string>::counts() );
+*
+* The wrapper provides the same special member functions as 'T' (including their 'noexcept'
+* specification). Note that a type without move operations is copied even from rvalues; in order
+* to count the copies of such a type, wrap its data members instead of the type itself.
+*
+* The 'S' types of the RVO exercises intentionally do not use the wrapper: the exercises stay
+* independent of the harness and print every call via 'std::puts()', since they are about the
+* order of the calls. The order is recorded by the traced builds of the exercises (e.g.
+* 'RVO3_Trace', see <benchmark/trace_puts.h>).
+*
+**************************************************************************************************/
+
+#ifndef BENCHMARK_TRACED_H
+#define BENCHMARK_TRACED_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace benchmark {
+
+//---- <TracedCounts> -----------------------------------------------------------------------------
+
+struct TracedCounts
+{
+   int64_t defaultConstructions{};
+   int64_t valueConstructions{};  // Constructions from the arguments of a constructor of 'T'
+   int64_t copyConstructions{};
+   int64_t moveConstructions{};
+   int64_t copyAssignments{};
+   int64_t moveAssignments{};
+   int64_t destructions{};
+
+   int64_t constructions() const
+   {
+      return defaultConstructions + valueConstructions + copyConstructions + moveConstructions;
+   }
+
+   int64_t copies() const { return copyConstructions + copyAssignments; }
+   int64_t moves() const { return moveConstructions + moveAssignments; }
+};
+
+
+namespace internal {
+
+//---- <TracedRegistry> ---------------------------------------------------------------------------
+
+enum TracedOperation : std::size_t
+{
+   DefaultConstruction,
+   ValueConstruction,
+   CopyConstruction,
+   MoveConstruction,
+   CopyAssignment,
+   MoveAssignment,
+   Destruction,
+   TracedOperations
+};
+
+// Counters of a single thread. Since only the owning thread modifies the counters, an increment
+// is a relaxed load and store (i.e. a plain increment without a locked instruction); the atomics
+// only allow other threads to read the counters concurrently.
+struct TracedCounters
+{
+   void increment( TracedOperation operation ) noexcept
+   {
+      auto& counter( values[operation] );
+      counter.store( counter.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+   }
+
+   std::array< std::atomic<int64_t>, TracedOperations > values{};
+};
+
+// Registry of the counters of all threads for a single wrapped type. The counters of a thread
+// that has terminated are added to the 'retired' counters.
+class TracedRegistry
+{
+ public:
+   void add( TracedCounters* counters )
+   {
+      std::lock_guard<std::mutex> const lock( mutex_ );
+      threads_.push_back( counters );
+   }
+
+   void remove( TracedCounters* counters )
+   {
+      std::lock_guard<std::mutex> const lock( mutex_ );
+      for( std::size_t i=0UL; i<TracedOperations; ++i ) {
+         retired_[i] += counters->values[i].load( std::memory_order_relaxed );
+      }
+      threads_.erase( std::remove( threads_.begin(), threads_.end(), counters ), threads_.end() );
+   }
+
+   // Returns the sum of the counters of all threads since the last call to 'reset()'.
+   TracedCounts counts() const
+   {
+      std::lock_guard<std::mutex> const lock( mutex_ );
+      Values const values( total() );
+      return TracedCounts{ values[DefaultConstruction] - baseline_[DefaultConstruction]
+                         , values[ValueConstruction]   - baseline_[ValueConstruction]
+                         , values[CopyConstruction]    - baseline_[CopyConstruction]
+                         , values[MoveConstruction]    - baseline_[MoveConstruction]
+                         , values[CopyAssignment]      - baseline_[CopyAssignment]
+                         , values[MoveAssignment]      - baseline_[MoveAssignment]
+                         , values[Destruction]         - baseline_[Destruction] };
+   }
+
+   // Resets the counts (by remembering the current sum, i.e. without touching the counters of
+   // other threads).
+   void reset()
+   {
+      std::lock_guard<std::mutex> const lock( mutex_ );
+      baseline_ = total();
+   }
+
+ private:
+   using Values = std::array<int64_t,TracedOperations>;
+
+   Values total() const
+   {
+      Values result( retired_ );
+      for( TracedCounters const* counters : threads_ ) {
+         for( std::size_t i=0UL; i<TracedOperations; ++i ) {
+            result[i] += counters->values[i].load( std::memory_order_relaxed );
+         }
+      }
+      return result;
+   }
+
+   mutable std::mutex mutex_{};
+   std::vector<TracedCounters*> threads_{};
+   Values retired_{};
+   Values baseline_{};
+};
+
+template< typename T >
+TracedRegistry& tracedRegistry()
+{
+   static TracedRegistry registry{};
+   return registry;
+}
+
+// Returns the counters of the calling thread for the given type; the counters are registered on
+// first use and retired on thread exit.
+template< typename T >
+TracedCounters& tracedCounters() noexcept
+{
+   struct ThreadCounters
+   {
+      ThreadCounters() { tracedRegistry<T>().add( &counters ); }
+      ~ThreadCounters() { tracedRegistry<T>().remove( &counters ); }
+
+      TracedCounters counters{};
+   };
+
+   thread_local ThreadCounters local{};
+   return local.counters;
+}
+
+} // namespace internal
+
+
+//---- <Traced> -----------------------------------------------------------------------------------
+
+template< typename T >
+class Traced
+{
+ public:
+   Traced() noexcept( std::is_nothrow_default_constructible_v<T> )
+      requires std::is_default_constructible_v<T>
+      : value_{}
+   {
+      count( internal::DefaultConstruction );
+   }
+
+   template< typename... Args >
+      requires ( sizeof...(Args) > 0UL ) && std::is_constructible_v<T,Args...> &&
+               ( !std::is_same_v< std::remove_cvref_t<Args>, Traced > && ... )
+   Traced( Args&&... args ) noexcept( std::is_nothrow_constructible_v<T,Args...> )
+      : value_( std::forward<Args>( args )... )
+   {
+      count( internal::ValueConstruction );
+   }
+
+   Traced( Traced const& other ) noexcept( std::is_nothrow_copy_constructible_v<T> )
+      requires std::is_copy_constructible_v<T>
+      : value_( other.value_ )
+   {
+      count( internal::CopyConstruction );
+   }
+
+   Traced( Traced&& other ) noexcept( std::is_nothrow_move_constructible_v<T> )
+      requires std::is_move_constructible_v<T>
+      : value_( std::move( other.value_ ) )
+   {
+      count( internal::MoveConstruction );
+   }
+
+   Traced& operator=( Traced const& other ) noexcept( std::is_nothrow_copy_assignable_v<T> )
+      requires std::is_copy_assignable_v<T>
+   {
+      value_ = other.value_;
+      count( internal::CopyAssignment );
+      return *this;
+   }
+
+   Traced& operator=( Traced&& other ) noexcept( std::is_nothrow_move_assignable_v<T> )
+      requires std::is_move_assignable_v<T>
+   {
+      value_ = std::move( other.value_ );
+      count( internal::MoveAssignment );
+      return *this;
+   }
+
+   ~Traced()
+   {
+      count( internal::Destruction );
+   }
+
+   T&       value()       noexcept { return value_; }
+   T const& value() const noexcept { return value_; }
+
+   T&       operator*()       noexcept { return value_; }
+   T const& operator*() const noexcept { return value_; }
+
+   T*       operator->()       noexcept { return &value_; }
+   T const* operator->() const noexcept { return &value_; }
+
+   // Returns the counts of all 'Traced<T>' objects in all threads since the last 'reset()'.
+   static TracedCounts counts() { return internal::tracedRegistry<T>().counts(); }
+   static void reset() { internal::tracedRegistry<T>().reset(); }
+
+ private:
+   static void count( internal::TracedOperation operation ) noexcept
+   {
+      internal::tracedCounters<T>().increment( operation );
+   }
+
+   T value_;
+};
+
+} // namespace benchmark
+
+#endif
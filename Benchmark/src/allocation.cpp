@@ -0,0 +1,197 @@
+/**************************************************************************************************
+*
+* \file allocation.cpp
+* \brief C++ Training - Replacement of the global operator new/delete to count heap allocations
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#include <benchmark/benchmark.h>
+#include "heap_profile.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__) || defined(_WIN32)
+#  include <malloc.h>
+#endif
+
+
+namespace benchmark {
+
+namespace {
+
+// The counters are only updated while tracking is enabled. Thus the replaced operators only cost
+// a single relaxed load during regular (timed) benchmark runs.
+std::atomic<bool>    tracking{ false };
+std::atomic<int64_t> allocations{};
+std::atomic<int64_t> deallocations{};
+std::atomic<int64_t> bytes{};
+std::atomic<int64_t> liveBytes{};
+std::atomic<int64_t> peakBytes{};
+
+// Returns the actual size of the given heap block, which is the only size that is known again
+// when the block is deallocated.
+int64_t blockSize( [[maybe_unused]] void* ptr ) noexcept
+{
+#if defined(__GLIBC__)
+   return static_cast<int64_t>( ::malloc_usable_size( ptr ) );
+#else
+   return 0;
+#endif
+}
+
+void recordAllocation( void* ptr, std::size_t size ) noexcept
+{
+   if( tracking.load( std::memory_order_relaxed ) ) {
+      allocations.fetch_add( 1, std::memory_order_relaxed );
+      bytes.fetch_add( static_cast<int64_t>( size ), std::memory_order_relaxed );
+
+      int64_t const block( blockSize( ptr ) );
+      int64_t const live( liveBytes.fetch_add( block, std::memory_order_relaxed ) + block );
+      int64_t peak( peakBytes.load( std::memory_order_relaxed ) );
+      while( live > peak && !peakBytes.compare_exchange_weak( peak, live, std::memory_order_relaxed ) ) {}
+   }
+}
+
+void recordDeallocation( void* ptr ) noexcept
+{
+   if( ptr != nullptr && tracking.load( std::memory_order_relaxed ) ) {
+      deallocations.fetch_add( 1, std::memory_order_relaxed );
+      liveBytes.fetch_sub( blockSize( ptr ), std::memory_order_relaxed );
+   }
+}
+
+// Not inlined to provide a stable call stack for the heap profiler (see 'sampleAllocation()')
+[[gnu::noinline]] void* allocate( std::size_t size ) noexcept
+{
+   if( size == 0UL ) size = 1UL;
+   void* const ptr( std::malloc( size ) );
+   if( ptr != nullptr ) {
+      recordAllocation( ptr, size );
+      if( internal::heapProfiling() ) internal::sampleAllocation( size );
+   }
+   return ptr;
+}
+
+[[gnu::noinline]] void* allocate( std::size_t size, std::align_val_t alignment ) noexcept
+{
+   std::size_t const align( static_cast<std::size_t>( alignment ) );
+   std::size_t const rounded( ( ( size > 0UL ? size : 1UL ) + align - 1UL ) / align * align );
+#if defined(_WIN32)
+   // The MSVC runtime does not provide 'std::aligned_alloc()' (see 'deallocateAligned()')
+   void* const ptr( ::_aligned_malloc( rounded, align ) );
+#else
+   void* const ptr( std::aligned_alloc( align, rounded ) );
+#endif
+   if( ptr != nullptr ) {
+      recordAllocation( ptr, size );
+      if( internal::heapProfiling() ) internal::sampleAllocation( size );
+   }
+   return ptr;
+}
+
+void deallocate( void* ptr ) noexcept
+{
+   recordDeallocation( ptr );
+   std::free( ptr );
+}
+
+void deallocateAligned( void* ptr ) noexcept
+{
+   recordDeallocation( ptr );
+#if defined(_WIN32)
+   ::_aligned_free( ptr );
+#else
+   std::free( ptr );
+#endif
+}
+
+} // namespace
+
+
+void StartAllocationTracking()
+{
+   allocations.store( 0, std::memory_order_relaxed );
+   deallocations.store( 0, std::memory_order_relaxed );
+   bytes.store( 0, std::memory_order_relaxed );
+   liveBytes.store( 0, std::memory_order_relaxed );
+   peakBytes.store( 0, std::memory_order_relaxed );
+   tracking.store( true, std::memory_order_release );
+}
+
+AllocationCounts StopAllocationTracking()
+{
+   tracking.store( false, std::memory_order_release );
+   return AllocationCounts{ allocations.load( std::memory_order_relaxed )
+                          , deallocations.load( std::memory_order_relaxed )
+                          , bytes.load( std::memory_order_relaxed )
+                          , peakBytes.load( std::memory_order_relaxed ) };
+}
+
+} // namespace benchmark
+
+
+//---- Replaceable global allocation functions ----------------------------------------------------
+
+void* operator new( std::size_t size )
+{
+   if( void* const ptr = benchmark::allocate( size ) ) return ptr;
+   throw std::bad_alloc{};
+}
+
+void* operator new[]( std::size_t size )
+{
+   if( void* const ptr = benchmark::allocate( size ) ) return ptr;
+   throw std::bad_alloc{};
+}
+
+void* operator new( std::size_t size, std::align_val_t alignment )
+{
+   if( void* const ptr = benchmark::allocate( size, alignment ) ) return ptr;
+   throw std::bad_alloc{};
+}
+
+void* operator new[]( std::size_t size, std::align_val_t alignment )
+{
+   if( void* const ptr = benchmark::allocate( size, alignment ) ) return ptr;
+   throw std::bad_alloc{};
+}
+
+void* operator new( std::size_t size, std::nothrow_t const& ) noexcept
+{
+   return benchmark::allocate( size );
+}
+
+void* operator new[]( std::size_t size, std::nothrow_t const& ) noexcept
+{
+   return benchmark::allocate( size );
+}
+
+void* operator new( std::size_t size, std::align_val_t alignment, std::nothrow_t const& ) noexcept
+{
+   return benchmark::allocate( size, alignment );
+}
+
+void* operator new[]( std::size_t size, std::align_val_t alignment, std::nothrow_t const& ) noexcept
+{
+   return benchmark::allocate( size, alignment );
+}
+
+void operator delete( void* ptr ) noexcept { benchmark::deallocate( ptr ); }
+void operator delete[]( void* ptr ) noexcept { benchmark::deallocate( ptr ); }
+void operator delete( void* ptr, std::size_t ) noexcept { benchmark::deallocate( ptr ); }
+void operator delete[]( void* ptr, std::size_t ) noexcept { benchmark::deallocate( ptr ); }
+void operator delete( void* ptr, std::align_val_t ) noexcept { benchmark::deallocateAligned( ptr ); }
+void operator delete[]( void* ptr, std::align_val_t ) noexcept { benchmark::deallocateAligned( ptr ); }
+void operator delete( void* ptr, std::size_t, std::align_val_t ) noexcept { benchmark::deallocateAligned( ptr ); }
+void operator delete[]( void* ptr, std::size_t, std::align_val_t ) noexcept { benchmark::deallocateAligned( ptr ); }
+void operator delete( void* ptr, std::nothrow_t const& ) noexcept { benchmark::deallocate( ptr ); }
+void operator delete[]( void* ptr, std::nothrow_t const& ) noexcept { benchmark::deallocate( ptr ); }
+void operator delete( void* ptr, std::align_val_t, std::nothrow_t const& ) noexcept { benchmark::deallocateAligned( ptr ); }
+void operator delete[]( void* ptr, std::align_val_t, std::nothrow_t const& ) noexcept { benchmark::deallocateAligned( ptr ); }
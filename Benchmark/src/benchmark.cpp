@@ -0,0 +1,977 @@
+/**************************************************************************************************
+*
+* \file benchmark.cpp
+* \brief C++ Training - Self-contained micro benchmark harness
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#include <benchmark/benchmark.h>
+#include "memory_usage.h"
+#include "perf_counters.h"
+#include "reporter.h"
+#include "statistics.h"
+#include "system.h"
+#include "timer.h"
+
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace benchmark {
+
+namespace internal {
+
+//---- <ThreadBarrier> ----------------------------------------------------------------------------
+
+class ThreadBarrier
+{
+ public:
+   explicit ThreadBarrier( int threads )
+      : barrier_{ threads }
+   {}
+
+   void wait() { barrier_.arrive_and_wait(); }
+
+ private:
+   std::barrier<> barrier_;
+};
+
+} // namespace internal
+
+
+//---- <State> ------------------------------------------------------------------------------------
+
+State::State( int64_t maxIterations, std::vector<int64_t> args, int threadIndex, int threads,
+              internal::ThreadBarrier* barrier )
+   : max_iterations{ maxIterations }
+   , args_         { std::move(args) }
+   , threadIndex_  { threadIndex }
+   , threads_      { threads }
+   , barrier_      { barrier }
+{}
+
+bool State::KeepRunning()
+{
+   if( !started_ ) {
+      startKeepRunning();
+   }
+   if( completed_ < max_iterations ) {
+      ++completed_;
+      return true;
+   }
+   finishKeepRunning();
+   return false;
+}
+
+void State::PauseTiming()
+{
+   if( running_ ) {
+      seconds_ += internal::Timer::seconds( internal::Timer::now() - start_ );
+      if( perf_ ) perf_->stop();
+      running_ = false;
+   }
+}
+
+void State::ResumeTiming()
+{
+   if( !running_ ) {
+      running_ = true;
+      if( perf_ ) perf_->start();
+      ++intervals_;
+      start_ = internal::Timer::now();
+   }
+}
+
+void State::RecordHeapStatistics()
+{
+   if( recordHeapStatistics_ ) {
+      heapStatistics_ = GetHeapStatistics();
+      hasHeapStatistics_ = true;
+   }
+}
+
+void State::startKeepRunning()
+{
+   started_ = true;
+
+   // All threads start measuring at the same time
+   if( barrier_ ) barrier_->wait();
+
+   ResumeTiming();
+}
+
+void State::finishKeepRunning()
+{
+   if( finished_ ) return;
+
+   PauseTiming();
+   completed_ = max_iterations;
+   finished_ = true;
+}
+
+
+namespace internal {
+
+#if !defined(__GNUC__) && !defined(__clang__)
+void useCharPointer( char const volatile* ) {}
+#endif
+
+
+//---- <Benchmark> --------------------------------------------------------------------------------
+
+Benchmark::Benchmark( std::string name, Function* function )
+   : name_    { std::move(name) }
+   , function_{ function }
+{}
+
+Benchmark* Benchmark::Iterations( int64_t iterations )
+{
+   iterations_ = iterations;
+   return this;
+}
+
+Benchmark* Benchmark::Repetitions( int repetitions )
+{
+   repetitions_ = repetitions;
+   return this;
+}
+
+Benchmark* Benchmark::MinTime( double seconds )
+{
+   minTime_ = seconds;
+   return this;
+}
+
+Benchmark* Benchmark::MinWarmUpTime( double seconds )
+{
+   minWarmUpTime_ = seconds;
+   return this;
+}
+
+Benchmark* Benchmark::Unit( TimeUnit unit )
+{
+   unit_ = unit;
+   hasUnit_ = true;
+   return this;
+}
+
+Benchmark* Benchmark::Arg( int64_t arg )
+{
+   args_.push_back( { arg } );
+   return this;
+}
+
+Benchmark* Benchmark::Args( std::vector<int64_t> const& args )
+{
+   args_.push_back( args );
+   return this;
+}
+
+Benchmark* Benchmark::Range( int64_t lo, int64_t hi )
+{
+   return Ranges( { { lo, hi } } );
+}
+
+Benchmark* Benchmark::Ranges( std::vector< std::pair<int64_t,int64_t> > const& ranges )
+{
+   std::vector< std::vector<int64_t> > arglists{};
+   for( auto const& [lo,hi] : ranges ) {
+      arglists.push_back( CreateRange( lo, hi, rangeMultiplier_ ) );
+   }
+   return ArgsProduct( arglists );
+}
+
+Benchmark* Benchmark::RangeMultiplier( int multiplier )
+{
+   rangeMultiplier_ = multiplier;
+   return this;
+}
+
+Benchmark* Benchmark::DenseRange( int64_t lo, int64_t hi, int64_t step )
+{
+   for( int64_t const arg : CreateDenseRange( lo, hi, step ) ) {
+      Arg( arg );
+   }
+   return this;
+}
+
+Benchmark* Benchmark::ArgsProduct( std::vector< std::vector<int64_t> > const& arglists )
+{
+   std::vector<std::size_t> indices( arglists.size(), 0UL );
+
+   for( auto const& arglist : arglists ) {
+      if( arglist.empty() ) return this;
+   }
+
+   while( true )
+   {
+      std::vector<int64_t> args{};
+      for( std::size_t i=0UL; i<arglists.size(); ++i ) {
+         args.push_back( arglists[i][indices[i]] );
+      }
+      args_.push_back( std::move(args) );
+
+      // Advance the indices like an odometer (the last argument varies fastest)
+      std::size_t i( arglists.size() );
+      while( i > 0UL && ++indices[i-1UL] == arglists[i-1UL].size() ) {
+         indices[i-1UL] = 0UL;
+         --i;
+      }
+      if( i == 0UL ) return this;
+   }
+}
+
+Benchmark* Benchmark::ArgNames( std::vector<std::string> const& names )
+{
+   argNames_ = names;
+   return this;
+}
+
+Benchmark* Benchmark::Threads( int threads )
+{
+   threads_.push_back( threads );
+   return this;
+}
+
+Benchmark* Benchmark::ThreadRange( int min, int max )
+{
+   for( int64_t const threads : CreateRange( min, max, 2 ) ) {
+      Threads( static_cast<int>( threads ) );
+   }
+   return this;
+}
+
+Benchmark* Benchmark::CacheModes()
+{
+   cacheModes_ = true;
+   return this;
+}
+
+Benchmark* Benchmark::ExplicitOnly()
+{
+   explicitOnly_ = true;
+   return this;
+}
+
+
+//---- Registry and command line options ----------------------------------------------------------
+
+namespace {
+
+std::vector<std::unique_ptr<Benchmark>>& registry()
+{
+   static std::vector<std::unique_ptr<Benchmark>> benchmarks{};
+   return benchmarks;
+}
+
+struct Options
+{
+   std::string filter{ "." };
+   bool hasFilter{ false };
+   int repetitions{ 5 };
+   double minTime{ 0.5 };
+   double minWarmUpTime{ 0.1 };
+   std::string clock{ "steady" };
+   bool subtractOverhead{ true };
+   int cpu{ -1 };
+   double maxCv{ 0.0 };
+   int maxRepetitions{ 0 };
+   bool aggregatesOnly{ false };
+   bool countAllocations{ true };
+   bool perfCounters{ true };
+   bool heapStats{ false };
+   std::string format{ "console" };
+   std::string out{};
+   std::string outFormat{ "json" };
+};
+
+Options& options()
+{
+   static Options opts{};
+   return opts;
+}
+
+// Parses a '--name=value' argument; returns 'false' in case the argument does not match.
+bool parseFlag( char const* arg, char const* name, std::string& value )
+{
+   std::size_t const length( std::strlen( name ) );
+   if( std::strncmp( arg, "--", 2 ) != 0 || std::strncmp( arg+2, name, length ) != 0 ) {
+      return false;
+   }
+   if( arg[2+length] == '\0' ) {
+      value = "true";
+      return true;
+   }
+   if( arg[2+length] != '=' ) {
+      return false;
+   }
+   value = arg + 3 + length;
+   return true;
+}
+
+bool toBool( std::string const& value )
+{
+   return value == "true" || value == "1" || value == "yes";
+}
+
+char const* programName{ "benchmark" };
+
+// Reports a malformed flag value and terminates the program.
+[[noreturn]] void invalidValue( std::string const& value, char const* name )
+{
+   std::cerr << "Error: Invalid value '" << value << "' for '--" << name << "'\n"
+             << "Run '" << programName << " --help' for the list of flags\n";
+   std::exit( EXIT_FAILURE );
+}
+
+int toInt( std::string const& value, char const* name )
+{
+   try {
+      std::size_t pos{};
+      int const result( std::stoi( value, &pos ) );
+      if( pos == value.size() ) return result;
+   }
+   catch( std::logic_error const& ) {}
+   invalidValue( value, name );
+}
+
+double toDouble( std::string const& value, char const* name )
+{
+   try {
+      std::size_t pos{};
+      double const result( std::stod( value, &pos ) );
+      if( pos == value.size() ) return result;
+   }
+   catch( std::logic_error const& ) {}
+   invalidValue( value, name );
+}
+
+// Accepts both '0.5' and the newer Google Benchmark notation '0.5s'.
+double toSeconds( std::string value, char const* name )
+{
+   if( !value.empty() && value.back() == 's' ) {
+      value.pop_back();
+   }
+   return toDouble( value, name );
+}
+
+TimeUnit chooseUnit( double seconds )
+{
+   if( seconds < 1E-6 ) return kNanosecond;
+   if( seconds < 1E-3 ) return kMicrosecond;
+   if( seconds < 1.0  ) return kMillisecond;
+   return kSecond;
+}
+
+
+//---- Hardware counters --------------------------------------------------------------------------
+
+PerfCounters* perfCounters()
+{
+   static std::unique_ptr<PerfCounters> const counters( []{
+      auto counters( PerfCounters::create() );
+      if( !counters ) {
+         std::cerr << "Note: Hardware performance counters are not available "
+                      "(see /proc/sys/kernel/perf_event_paranoid)\n";
+      }
+      return counters;
+   }() );
+
+   return counters.get();
+}
+
+// Returns the overhead of a single timed interval (i.e. of a pair of timer reads), which is
+// subtracted from the measured time of every 'ResumeTiming()'/'PauseTiming()' interval.
+double timerOverhead()
+{
+   static double const overhead( options().subtractOverhead ? Timer::overhead() : 0.0 );
+   return overhead;
+}
+
+// Normalizes the raw hardware counts per processed element (if 'SetItemsProcessed()' has been
+// used) or per iteration and adds the derived instructions per cycle (IPC).
+Counters normalizePerfCounters( Counters const& values, int64_t items, int64_t iterations )
+{
+   bool const perItem( items > 0 );
+   double const n( static_cast<double>( perItem ? items : iterations ) );
+
+   Counters result{};
+   double cycles{}, instructions{};
+
+   for( auto const& [name,value] : values ) {
+      if( name == "cycles" ) cycles = value;
+      if( name == "instructions" ) instructions = value;
+      result.emplace_back( name + ( perItem ? "/item" : "/iter" ), value / n );
+   }
+
+   if( cycles > 0.0 && instructions > 0.0 ) {
+      result.emplace_back( "IPC", instructions / cycles );
+   }
+
+   return result;
+}
+
+} // namespace
+
+
+//---- <BenchmarkRunner> --------------------------------------------------------------------------
+
+// Single run of a benchmark (i.e. one combination of arguments and number of threads).
+struct Instance
+{
+   Benchmark const* benchmark{};
+   std::string name{};
+   std::string family{};  // Name without the number of threads
+   std::vector<int64_t> args{};
+   int threads{ 1 };
+   bool coldCache{ false };
+};
+
+// Time per iteration of the single-threaded runs, used to compute the scaling efficiency of
+// the multi-threaded runs of the same benchmark.
+std::map<std::string,double>& singleThreadTimes()
+{
+   static std::map<std::string,double> times{};
+   return times;
+}
+
+class BenchmarkRunner
+{
+ public:
+   explicit BenchmarkRunner( Instance const& instance )
+      : benchmark_  { *instance.benchmark }
+      , instance_   { instance }
+      , repetitions_{ benchmark_.repetitions_ > 0 ? benchmark_.repetitions_ : options().repetitions }
+      , minTime_    { benchmark_.minTime_ > 0.0 ? benchmark_.minTime_ : options().minTime }
+      , minWarmUpTime_{ benchmark_.minWarmUpTime_ >= 0.0 ? benchmark_.minWarmUpTime_ : options().minWarmUpTime }
+   {}
+
+   // Returns all runs of the given benchmark (e.g. 'name/N:100/32/cache:cold/threads:4').
+   static std::vector<Instance> instances( Benchmark const& benchmark )
+   {
+      std::vector< std::vector<int64_t> > arglists( benchmark.args_ );
+      if( arglists.empty() ) {
+         arglists.emplace_back();
+      }
+
+      std::vector<int> threadCounts( benchmark.threads_ );
+      if( threadCounts.empty() ) {
+         threadCounts.push_back( 1 );
+      }
+
+      std::vector<bool> coldCaches{ false };
+      if( benchmark.cacheModes_ ) {
+         coldCaches.push_back( true );
+      }
+
+      std::vector<Instance> result{};
+
+      for( auto const& args : arglists )
+      {
+         std::string base( benchmark.name_ );
+         for( std::size_t i=0UL; i<args.size(); ++i ) {
+            base += "/";
+            if( i < benchmark.argNames_.size() && !benchmark.argNames_[i].empty() ) {
+               base += benchmark.argNames_[i] + ":";
+            }
+            base += std::to_string( args[i] );
+         }
+
+         for( bool const coldCache : coldCaches )
+         {
+            std::string family( base );
+            if( benchmark.cacheModes_ ) {
+               family += coldCache ? "/cache:cold" : "/cache:warm";
+            }
+
+            for( int const threads : threadCounts ) {
+               std::string name( family );
+               if( !benchmark.threads_.empty() ) {
+                  name += "/threads:" + std::to_string( threads );
+               }
+               result.push_back( Instance{ &benchmark, std::move(name), family, args, threads, coldCache } );
+            }
+         }
+      }
+
+      return result;
+   }
+
+   Run run()
+   {
+      int64_t const iterations( predictIterations() );
+
+      warmUp( iterations );
+
+      Counters const memory( options().countAllocations ? measureAllocations( iterations ) : Counters{} );
+
+      Run result{ instance_.name, instance_.args, iterations, benchmark_.unit_, {} };
+
+      // In noise-detection mode, additional repetitions are performed until the coefficient of
+      // variation drops below the threshold; runs that never get there are flagged as noisy
+      double const maxCv( options().maxCv / 100.0 );
+      int const maxRepetitions( std::max( repetitions_, options().maxRepetitions > 0
+                                                        ? options().maxRepetitions : 10*repetitions_ ) );
+
+      for( int i=0; i<maxRepetitions; ++i )
+      {
+         if( i >= repetitions_ && ( maxCv <= 0.0 || cv( times( result ) ) <= maxCv ) ) break;
+
+         Repetition repetition( runOnce( iterations ) );
+         repetition.counters.insert( begin(repetition.counters), begin(memory), end(memory) );
+         result.repetitions.push_back( std::move(repetition) );
+      }
+
+      result.noisy = ( maxCv > 0.0 && cv( times( result ) ) > maxCv );
+
+      if( !benchmark_.threads_.empty() ) {
+         addScalingEfficiency( result );
+      }
+
+      if( !benchmark_.hasUnit_ ) {
+         result.unit = chooseUnit( result.repetitions.front().seconds );
+      }
+
+      return result;
+   }
+
+ private:
+   using States = std::vector< std::unique_ptr<State> >;
+
+   // Executes the benchmark function with the given number of iterations on all threads. The
+   // first thread runs on the calling thread, which is also the only one to be observed by the
+   // hardware counters.
+   States execute( int64_t iterations, PerfCounters* perf ) const
+   {
+      int const threads( instance_.threads );
+      ThreadBarrier barrier( threads );
+
+      States states{};
+      for( int t=0; t<threads; ++t ) {
+         states.emplace_back( new State{ iterations, instance_.args, t, threads,
+                                         threads > 1 ? &barrier : nullptr } );
+      }
+      states.front()->perf_ = perf;
+      states.front()->recordHeapStatistics_ = options().heapStats;
+
+      // In case the benchmark is pinned, the worker threads are pinned to the subsequent CPUs
+      int const cpu( options().cpu );
+      int const cpus( static_cast<int>( std::max( std::thread::hardware_concurrency(), 1U ) ) );
+
+      std::vector<std::thread> workers{};
+      for( int t=1; t<threads; ++t ) {
+         workers.emplace_back( [this,&states,t,cpu,cpus]{
+            if( cpu >= 0 ) pinThread( ( cpu + t ) % cpus );
+            benchmark_.function_( *states[t] );
+         } );
+      }
+      benchmark_.function_( *states.front() );
+
+      for( auto& worker : workers ) {
+         worker.join();
+      }
+
+      return states;
+   }
+
+   // Executes the benchmark function once with the given number of iterations. The time of a
+   // multi-threaded run is the time of the slowest thread. For a cold-cache run, the last-level
+   // cache is evicted beforehand.
+   Repetition runOnce( int64_t iterations ) const
+   {
+      if( instance_.coldCache ) {
+         evictCache();
+      }
+
+      PerfCounters* const perf( options().perfCounters ? perfCounters() : nullptr );
+      if( perf ) perf->reset();
+
+      States const states( execute( iterations, perf ) );
+
+      double seconds{};
+      int64_t items{};
+      LatencyHistogram latencies{};
+      for( auto const& state : states ) {
+         latencies.merge( state->latencies_ );
+         double const overhead( static_cast<double>( state->intervals_ ) * timerOverhead() );
+         seconds = std::max( seconds, std::max( state->elapsedSeconds() - overhead, 0.0 ) );
+         items += state->items_processed();
+      }
+
+      Repetition repetition{ seconds / static_cast<double>( iterations ), {} };
+      if( perf ) {
+         repetition.counters = normalizePerfCounters( perf->values(), states.front()->items_processed(), iterations );
+      }
+
+      std::map<std::string,double> user{};
+      for( auto const& state : states ) {
+         for( auto const& [name,value] : state->counters ) {
+            user[name] += value;
+         }
+      }
+      repetition.counters.insert( end(repetition.counters), begin(user), end(user) );
+
+      if( latencies.count() > 0 ) {
+         repetition.counters.emplace_back( "p50-ns"  , static_cast<double>( latencies.percentile( 50.0 ) ) );
+         repetition.counters.emplace_back( "p99-ns"  , static_cast<double>( latencies.percentile( 99.0 ) ) );
+         repetition.counters.emplace_back( "p99.9-ns", static_cast<double>( latencies.percentile( 99.9 ) ) );
+         repetition.counters.emplace_back( "max-ns"  , static_cast<double>( latencies.max() ) );
+      }
+
+      if( options().heapStats ) {
+         State const& front( *states.front() );
+         addHeapStatistics( repetition.counters, front.hasHeapStatistics_ ? front.heapStatistics_
+                                                                          : GetHeapStatistics() );
+      }
+
+      if( !benchmark_.threads_.empty() && seconds > 0.0 ) {
+         double const perThread( static_cast<double>( items > 0 ? items : iterations * instance_.threads )
+                                 / instance_.threads / seconds );
+         repetition.counters.emplace_back( items > 0 ? "items/s/thread" : "iters/s/thread", perThread );
+      }
+
+      return repetition;
+   }
+
+   // Adds the state of the heap after the repetition (or at the point recorded by the benchmark
+   // via 'State::RecordHeapStatistics()'). Since the heap is shared by all benchmarks, the values
+   // also reflect the allocations performed by previous benchmarks.
+   static void addHeapStatistics( Counters& counters, HeapStatistics const& heap )
+   {
+      counters.emplace_back( "heap-in-use" , static_cast<double>( heap.inUse      ) );
+      counters.emplace_back( "heap-free"   , static_cast<double>( heap.free       ) );
+      counters.emplace_back( "heap-frag"   , heap.fragmentation() );
+      counters.emplace_back( "free-chunks" , static_cast<double>( heap.freeChunks ) );
+      counters.emplace_back( "heap-mmapped", static_cast<double>( heap.mmapped    ) );
+      counters.emplace_back( "heap-arenas" , static_cast<double>( heap.arenas     ) );
+   }
+
+   // Adds the scaling efficiency, i.e. the ratio of the single-threaded time to the time of the
+   // multi-threaded run (since every thread performs the same amount of work, the ideal is 1).
+   void addScalingEfficiency( Run& run ) const
+   {
+      auto& reference( singleThreadTimes() );
+
+      if( instance_.threads == 1 ) {
+         reference[instance_.family] = median( times( run ) );
+      }
+
+      auto const pos( reference.find( instance_.family ) );
+      if( pos == reference.end() ) return;
+
+      for( auto& repetition : run.repetitions ) {
+         repetition.counters.emplace_back( "efficiency", pos->second / repetition.seconds );
+      }
+   }
+
+   // Runs the benchmark (without reporting) until the minimum warm-up time has passed. Since the
+   // measured time of a run may be zero (e.g. for an optimized-away body or after subtracting the
+   // timer overhead), the warm-up is additionally bounded by the wall-clock time and the number of
+   // runs.
+   void warmUp( int64_t iterations ) const
+   {
+      using Clock = std::chrono::steady_clock;
+      constexpr int maxRuns( 1000 );
+
+      auto const deadline( Clock::now() + std::chrono::duration<double>( 2.0 * minWarmUpTime_ ) );
+      double elapsed{};
+      for( int run=0; elapsed < minWarmUpTime_ && run < maxRuns && Clock::now() < deadline; ++run ) {
+         elapsed += runOnce( iterations ).seconds * static_cast<double>( iterations );
+      }
+   }
+
+   // Performs one additional, untimed run with allocation tracking enabled. The tracking is not
+   // active during the timed runs to keep the measurements unaffected. For multi-threaded runs,
+   // the counts are reported per iteration and thread. The heap high-water mark ('heap-peak') and
+   // the peak resident set size ('RSS-peak') are reported for the entire run.
+   Counters measureAllocations( int64_t iterations ) const
+   {
+      resetPeakRss();
+      StartAllocationTracking();
+      execute( iterations, nullptr );
+      AllocationCounts const counts( StopAllocationTracking() );
+      int64_t const rss( peakRss() );
+
+      double const n( static_cast<double>( iterations * instance_.threads ) );
+      return Counters{ { "allocs/iter", static_cast<double>( counts.allocations   ) / n }
+                     , { "frees/iter" , static_cast<double>( counts.deallocations ) / n }
+                     , { "bytes/iter" , static_cast<double>( counts.bytes         ) / n }
+                     , { "heap-peak"  , static_cast<double>( counts.peakBytes     ) }
+                     , { "RSS-peak"   , static_cast<double>( rss                  ) } };
+   }
+
+   // Increases the number of iterations until a single run takes at least the minimum time.
+   int64_t predictIterations()
+   {
+      if( benchmark_.iterations_ > 0 ) {
+         return benchmark_.iterations_;
+      }
+
+      // Only the first iteration after evicting the cache runs on a cold cache
+      if( instance_.coldCache ) {
+         return 1;
+      }
+
+      constexpr int64_t maxIterations( 1000000000 );
+      int64_t iterations( 1 );
+
+      while( true )
+      {
+         double const seconds( runOnce( iterations ).seconds * static_cast<double>( iterations ) );
+
+         if( seconds >= minTime_ || iterations >= maxIterations ) {
+            return iterations;
+         }
+
+         // Aim slightly above the minimum time, but never grow more than 10x per step
+         double multiplier( minTime_ * 1.4 / std::max( seconds, 1E-9 ) );
+         if( seconds / minTime_ <= 0.1 ) {
+            multiplier = std::min( multiplier, 10.0 );
+         }
+         int64_t const next( static_cast<int64_t>( std::ceil( iterations * multiplier ) ) );
+         iterations = std::clamp( next, iterations+1, maxIterations );
+      }
+   }
+
+   Benchmark const& benchmark_;
+   Instance const& instance_;
+   int repetitions_{};
+   double minTime_{};
+   double minWarmUpTime_{};
+};
+
+} // namespace internal
+
+
+//---- Public interface ---------------------------------------------------------------------------
+
+internal::Benchmark* RegisterBenchmark( std::string name, Function* function )
+{
+   auto& benchmarks( internal::registry() );
+   benchmarks.push_back( std::make_unique<internal::Benchmark>( std::move(name), function ) );
+   return benchmarks.back().get();
+}
+
+std::vector<int64_t> CreateRange( int64_t lo, int64_t hi, int multiplier )
+{
+   std::vector<int64_t> result{ lo };
+   for( int64_t value=1; value<hi; value*=multiplier ) {
+      if( value > lo ) result.push_back( value );
+   }
+   if( hi > lo ) result.push_back( hi );
+   return result;
+}
+
+std::vector<int64_t> CreateDenseRange( int64_t lo, int64_t hi, int64_t step )
+{
+   std::vector<int64_t> result{};
+   for( int64_t value=lo; value<=hi; value+=step ) {
+      result.push_back( value );
+   }
+   return result;
+}
+
+void Initialize( int* argc, char** argv )
+{
+   auto& opts( internal::options() );
+
+   if( *argc > 0 ) {
+      internal::programName = argv[0];
+   }
+
+   int remaining( 1 );
+
+   for( int i=1; i<*argc; ++i )
+   {
+      std::string value{};
+
+      if( internal::parseFlag( argv[i], "benchmark_filter", value ) ) {
+         opts.filter = value;
+         opts.hasFilter = true;
+      }
+      else if( internal::parseFlag( argv[i], "benchmark_repetitions", value ) ) {
+         opts.repetitions = std::max( 1, internal::toInt( value, "benchmark_repetitions" ) );
+      }
+      else if( internal::parseFlag( argv[i], "benchmark_min_time", value ) ) {
+         opts.minTime = internal::toSeconds( value, "benchmark_min_time" );
+      }
+      else if( internal::parseFlag( argv[i], "benchmark_min_warmup_time", value ) ) {
+         opts.minWarmUpTime = internal::toSeconds( value, "benchmark_min_warmup_time" );
+      }
+      else if( internal::parseFlag( argv[i], "benchmark_clock", value ) ) {
+         opts.clock = value;
+      }
+      else if( internal::parseFlag( argv[i], "benchmark_subtract_overhead", value ) ) {
+         opts.subtractOverhead = internal::toBool( value );
+      }
+      else if( internal::parseFlag( argv[i], "benchmark_cpu", value ) ) {
+         opts.cpu = internal::toInt( value, "benchmark_cpu" );
+      }
+      else if( internal::parseFlag( argv[i], "benchmark_max_cv", value ) ) {
+         opts.maxCv = internal::toDouble( value, "benchmark_max_cv" );
+      }
+      else if( internal::parseFlag( argv[i], "benchmark_max_repetitions", value ) ) {
+         opts.maxRepetitions = internal::toInt( value, "benchmark_max_repetitions" );
+      }
+      else if( internal::parseFlag( argv[i], "benchmark_report_aggregates_only", value ) ) {
+         opts.aggregatesOnly = internal::toBool( value );
+      }
+      else if( internal::parseFlag( argv[i], "benchmark_count_allocations", value ) ) {
+         opts.countAllocations = internal::toBool( value );
+      }
+      else if( internal::parseFlag( argv[i], "benchmark_perf_counters", value ) ) {
+         opts.perfCounters = internal::toBool( value );
+      }
+      else if( internal::parseFlag( argv[i], "benchmark_heap_stats", value ) ) {
+         opts.heapStats = internal::toBool( value );
+      }
+      else if( internal::parseFlag( argv[i], "benchmark_format", value ) ) {
+         opts.format = value;
+      }
+      else if( internal::parseFlag( argv[i], "benchmark_out", value ) ) {
+         opts.out = value;
+      }
+      else if( internal::parseFlag( argv[i], "benchmark_out_format", value ) ) {
+         opts.outFormat = value;
+      }
+      else if( std::strcmp( argv[i], "--help" ) == 0 ) {
+         std::cout << "benchmark [--benchmark_filter=<regex>]\n"
+                      "          [--benchmark_repetitions=<num>]\n"
+                      "          [--benchmark_min_time=<seconds>]\n"
+                      "          [--benchmark_min_warmup_time=<seconds>]\n"
+                      "          [--benchmark_clock={steady|tsc}]\n"
+                      "          [--benchmark_subtract_overhead={true|false}]\n"
+                      "          [--benchmark_cpu=<cpu>]\n"
+                      "          [--benchmark_max_cv=<percent>]\n"
+                      "          [--benchmark_max_repetitions=<num>]\n"
+                      "          [--benchmark_report_aggregates_only={true|false}]\n"
+                      "          [--benchmark_count_allocations={true|false}]\n"
+                      "          [--benchmark_perf_counters={true|false}]\n"
+                      "          [--benchmark_heap_stats={true|false}]\n"
+                      "          [--benchmark_format={console|json|csv}]\n"
+                      "          [--benchmark_out=<filename>]\n"
+                      "          [--benchmark_out_format={console|json|csv}]\n";
+         std::exit( EXIT_SUCCESS );
+      }
+      else {
+         argv[remaining++] = argv[i];
+      }
+   }
+
+   *argc = remaining;
+}
+
+std::size_t RunSpecifiedBenchmarks()
+{
+   auto const& opts( internal::options() );
+
+   auto makeReporter = [&]( std::string const& format, std::ostream& os ) {
+      if( format == "json" ) return internal::makeJsonReporter( os );
+      if( format == "csv"  ) return internal::makeCsvReporter( os );
+      return internal::makeConsoleReporter( os, opts.aggregatesOnly );
+   };
+
+   std::vector<std::unique_ptr<internal::Reporter>> reporters{};
+   reporters.push_back( makeReporter( opts.format, std::cout ) );
+
+   std::ofstream file{};
+   if( !opts.out.empty() ) {
+      file.open( opts.out );
+      if( !file ) {
+         std::cerr << "Error: Unable to open output file '" << opts.out << "'\n";
+         std::exit( EXIT_FAILURE );
+      }
+      reporters.push_back( makeReporter( opts.outFormat, file ) );
+   }
+
+   if( opts.clock == "tsc" && !internal::Timer::useTsc() ) {
+      std::cerr << "Note: No invariant TSC available, falling back to the steady clock\n";
+   }
+
+   if( opts.cpu >= 0 )
+   {
+      if( !internal::pinThread( opts.cpu ) ) {
+         std::cerr << "Warning: Unable to pin the benchmark to CPU " << opts.cpu << "\n";
+      }
+
+      std::string const governor( internal::cpuGovernor( opts.cpu ) );
+      if( !governor.empty() && governor != "performance" ) {
+         std::cerr << "Warning: CPU " << opts.cpu << " uses the '" << governor << "' frequency "
+                      "governor; results may vary due to frequency scaling (consider 'performance')\n";
+      }
+   }
+
+   if( opts.perfCounters ) {
+      internal::perfCounters();
+   }
+
+   // Select all benchmark runs matching the filter
+   std::regex const filter( opts.filter );
+   std::vector<internal::Instance> selected{};
+   std::size_t nameWidth{};
+
+   for( auto const& benchmark : internal::registry() )
+   {
+      if( benchmark->explicitOnly() && !opts.hasFilter ) continue;
+
+      for( auto& instance : internal::BenchmarkRunner::instances( *benchmark ) ) {
+         if( !std::regex_search( instance.name, filter ) ) continue;
+         nameWidth = std::max( nameWidth, instance.name.size() + 7UL );
+         selected.push_back( std::move(instance) );
+      }
+   }
+
+   for( auto const& reporter : reporters ) {
+      reporter->reportContext( internal::programName, nameWidth );
+   }
+
+   std::size_t noisy{};
+
+   for( auto const& instance : selected )
+   {
+      internal::BenchmarkRunner runner{ instance };
+      internal::Run const run( runner.run() );
+      if( run.noisy ) ++noisy;
+
+      for( auto const& reporter : reporters ) {
+         reporter->reportRun( run );
+      }
+   }
+
+   for( auto const& reporter : reporters ) {
+      reporter->finalize();
+   }
+
+   if( noisy > 0UL ) {
+      std::cerr << "Warning: " << noisy << " benchmark(s) exceeded the coefficient of variation of "
+                << opts.maxCv << "% and should not be trusted\n";
+   }
+
+   return selected.size();
+}
+
+void Shutdown()
+{
+   internal::registry().clear();
+}
+
+} // namespace benchmark
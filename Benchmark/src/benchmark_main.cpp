@@ -0,0 +1,15 @@
+/**************************************************************************************************
+*
+* \file benchmark_main.cpp
+* \brief C++ Training - Default 'main()' function for all benchmark executables
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+BENCHMARK_MAIN();
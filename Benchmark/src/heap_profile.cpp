@@ -0,0 +1,361 @@
+/**************************************************************************************************
+*
+* \file heap_profile.cpp
+* \brief C++ Training - Sampling heap profiler of the benchmark harness
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#include "heap_profile.h"
+
+#if defined(__GLIBC__)
+#  include <cxxabi.h>
+#  include <dlfcn.h>
+#  include <execinfo.h>
+#  define BENCHMARK_HAS_BACKTRACE 1
+#else
+#  define BENCHMARK_HAS_BACKTRACE 0
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace benchmark {
+
+namespace internal {
+
+namespace {
+
+constexpr int maxFrames( 32 );  // Number of recorded frames per call stack
+constexpr int maxCallers( 4 );  // Number of reported frames per call site
+constexpr int skipFrames( 2 );  // 'sampleAllocation()' and the allocation function
+
+using Stack = std::array<void*,maxFrames>;
+
+struct Site
+{
+   int64_t allocations{};
+   int64_t bytes{};
+};
+
+// Recursion guard: the profiler itself allocates (and 'backtrace()' might do so on first use)
+thread_local bool inProfiler{ false };
+
+class HeapProfile
+{
+ public:
+   static HeapProfile* instance() noexcept
+   {
+      // Intentionally never destroyed, since allocations may happen until the very end
+      static HeapProfile* const profile( create() );
+      return profile;
+   }
+
+   void sample( std::size_t size, Stack const& stack )
+   {
+      std::lock_guard<std::mutex> const lock( mutex_ );
+      Site& site( sites_[stack] );
+      site.allocations += rate_;
+      site.bytes += static_cast<int64_t>( size ) * rate_;
+   }
+
+   bool sampleNext() const noexcept
+   {
+      thread_local int64_t counter{};
+      return ( ++counter % rate_ ) == 0;
+   }
+
+   void report() const;
+
+ private:
+   HeapProfile( std::string filename, int64_t rate )
+      : filename_{ std::move(filename) }
+      , rate_    { rate }
+   {}
+
+   static HeapProfile* create() noexcept
+   {
+      char const* const filename( std::getenv( "BENCHMARK_HEAP_PROFILE" ) );
+      if( !filename || !*filename ) return nullptr;
+
+      char const* const rate( std::getenv( "BENCHMARK_HEAP_PROFILE_RATE" ) );
+      int64_t const n( rate ? std::max( std::atoll( rate ), 1LL ) : 1LL );
+
+      inProfiler = true;
+      HeapProfile* const profile( new HeapProfile{ filename, n } );
+      std::atexit( []{ inProfiler = true; instance()->report(); } );
+      inProfiler = false;
+      return profile;
+   }
+
+   std::string filename_;
+   int64_t rate_{ 1 };
+   mutable std::mutex mutex_{};
+   std::map<Stack,Site> sites_{};
+};
+
+
+//---- Symbolization ------------------------------------------------------------------------------
+
+std::string demangle( char const* name )
+{
+#if BENCHMARK_HAS_BACKTRACE
+   int status{};
+   char* const demangled( abi::__cxa_demangle( name, nullptr, nullptr, &status ) );
+   if( status == 0 && demangled ) {
+      std::string result( demangled );
+      std::free( demangled );
+      return result;
+   }
+#endif
+   return name;
+}
+
+// Returns the function name and (if available) the source location of the given return address,
+// preferably via 'addr2line' (which also knows non-exported functions and line numbers).
+std::string symbolize( [[maybe_unused]] void* address )
+{
+#if BENCHMARK_HAS_BACKTRACE
+   Dl_info info{};
+   if( ::dladdr( address, &info ) == 0 || !info.dli_fname ) {
+      return "??";
+   }
+
+   // Return addresses point behind the call instruction, thus look up the previous byte
+   uintptr_t const offset( reinterpret_cast<uintptr_t>( address ) - 1U - reinterpret_cast<uintptr_t>( info.dli_fbase ) );
+
+   char command[1024]{};
+   std::snprintf( command, sizeof(command), "addr2line -C -f -e '%s' 0x%lx 2>/dev/null",
+                  info.dli_fname, static_cast<unsigned long>( offset ) );
+
+   if( FILE* const pipe = ::popen( command, "r" ) )
+   {
+      char function[1024]{};
+      char location[1024]{};
+      bool const success( std::fgets( function, sizeof(function), pipe ) &&
+                          std::fgets( location, sizeof(location), pipe ) );
+      ::pclose( pipe );
+
+      function[std::strcspn( function, "\n" )] = '\0';
+      location[std::strcspn( location, "\n" )] = '\0';
+
+      if( success && std::strcmp( function, "??" ) != 0 ) {
+         std::string result( function );
+         if( std::strncmp( location, "??", 2 ) != 0 ) {
+            char const* const file( std::strrchr( location, '/' ) );
+            result += std::string( " at " ) + ( file ? file+1 : location );
+         }
+         return result;
+      }
+   }
+
+   if( info.dli_sname ) {
+      return demangle( info.dli_sname );
+   }
+#endif
+   return "??";
+}
+
+// Returns the qualified name of the given (demangled) function, i.e. skips the return type, the
+// parameter list and the source location. The parameter list is the last top-level parenthesis, since the return type may
+// contain parentheses as well (e.g. 'decltype (::new ((void*)(0)) T(...)) std::construct_at<...>(...)').
+std::string qualifiedName( std::string const& function )
+{
+   // The angle brackets of operators (e.g. 'operator<<' or 'operator->') are no template brackets
+   // and the blank of 'operator new' (or of a conversion operator) does not separate a return type
+   std::string masked( function.substr( 0UL, function.find( " at " ) ) );  // Without the location
+   for( std::size_t pos=masked.find( "operator" ); pos!=std::string::npos; pos=masked.find( "operator", pos+1UL ) ) {
+      std::size_t i( pos+8UL );
+      if( i < masked.size() && masked[i] == ' ' ) masked[i++] = '_';
+      for( ; i<masked.size() && std::strchr( "<>=-", masked[i] ); ++i ) {
+         masked[i] = '_';
+      }
+   }
+
+   std::size_t end( masked.size() );
+   int angles{};
+   int parens{};
+   for( std::size_t i=0UL; i<masked.size(); ++i ) {
+      char const c( masked[i] );
+      if( c == '<' ) ++angles;
+      else if( c == '>' ) --angles;
+      else if( c == '(' && parens++ == 0 && angles == 0 ) end = i;
+      else if( c == ')' ) --parens;
+   }
+
+   std::size_t begin{};
+   angles = 0;
+   parens = 0;
+   for( std::size_t i=0UL; i<end; ++i ) {
+      char const c( masked[i] );
+      if( c == '<' ) ++angles;
+      else if( c == '>' ) --angles;
+      else if( c == '(' ) ++parens;
+      else if( c == ')' ) --parens;
+      else if( c == ' ' && angles == 0 && parens == 0 && masked[i+1UL] != '<' ) begin = i+1UL;
+   }
+
+   return function.substr( begin, end-begin );
+}
+
+// Returns whether the given (demangled) function belongs to the allocation functions or to the
+// standard library, i.e. whether it should be skipped to find the actual call site.
+bool isLibraryFunction( std::string const& function )
+{
+   if( function.rfind( "operator new", 0 ) == 0 ) return true;
+
+   std::string const name( qualifiedName( function ) );
+   return name.rfind( "std::", 0 ) == 0 || name.rfind( "__gnu_cxx::", 0 ) == 0;
+}
+
+// Returns whether the given (demangled) function belongs to the benchmark harness. These frames
+// are skipped, such that the allocations of a benchmark are attributed to the benchmark itself
+// (independent of the phase of the harness, e.g. warm-up or measurement).
+bool isHarnessFunction( std::string const& function )
+{
+   return qualifiedName( function ).rfind( "benchmark::", 0 ) == 0;
+}
+
+
+void HeapProfile::report() const
+{
+   FILE* const file( filename_ == "-" ? stderr : std::fopen( filename_.c_str(), "w" ) );
+   if( !file ) {
+      std::fprintf( stderr, "Error: Unable to write heap profile '%s'\n", filename_.c_str() );
+      return;
+   }
+
+   std::lock_guard<std::mutex> const lock( mutex_ );
+
+   // Symbolize all call stacks and merge the ones that only differ in library functions
+   std::map<void*,std::string> symbols{};
+   std::map<std::vector<std::string>,Site> callSites{};
+
+   for( auto const& [stack,site] : sites_ )
+   {
+      std::vector<std::string> callers{};
+      bool harness{ false };
+      for( void* const frame : stack )
+      {
+         if( !frame || callers.size() >= static_cast<std::size_t>( maxCallers ) ) break;
+
+         auto pos( symbols.find( frame ) );
+         if( pos == symbols.end() ) {
+            pos = symbols.emplace( frame, symbolize( frame ) ).first;
+         }
+         std::string const& function( pos->second );
+
+         if( isHarnessFunction( function ) ) {
+            harness = true;
+            continue;
+         }
+         if( callers.empty() && isLibraryFunction( function ) ) continue;
+
+         // Allocations of the harness itself (outside of any benchmark) reach 'main()' without
+         // passing any other function
+         if( qualifiedName( function ) == "main" ) {
+            callers.push_back( callers.empty() && harness ? "(benchmark harness)" : function );
+            break;
+         }
+         callers.push_back( function );
+      }
+
+      Site& callSite( callSites[callers] );
+      callSite.allocations += site.allocations;
+      callSite.bytes += site.bytes;
+   }
+
+   std::vector< std::pair<std::vector<std::string>,Site> > sorted( callSites.begin(), callSites.end() );
+   std::sort( sorted.begin(), sorted.end(),
+              []( auto const& lhs, auto const& rhs ){ return lhs.second.bytes > rhs.second.bytes; } );
+
+   int64_t totalAllocations{};
+   int64_t totalBytes{};
+   for( auto const& [callers,site] : sorted ) {
+      totalAllocations += site.allocations;
+      totalBytes += site.bytes;
+   }
+
+   std::fprintf( file, "Heap profile: %lld allocations, %lld bytes from %zu call sites (sampling every %lld allocation(s))\n\n",
+                 static_cast<long long>( totalAllocations ), static_cast<long long>( totalBytes ),
+                 sorted.size(), static_cast<long long>( rate_ ) );
+   std::fprintf( file, "%14s %6s %12s  %s\n", "Bytes", "%", "Allocations", "Call site" );
+
+   for( auto const& [callers,site] : sorted )
+   {
+      double const percent( totalBytes > 0 ? 100.0 * static_cast<double>( site.bytes ) / static_cast<double>( totalBytes ) : 0.0 );
+      std::fprintf( file, "%14lld %5.1f%% %12lld  %s\n", static_cast<long long>( site.bytes ), percent,
+                    static_cast<long long>( site.allocations ), callers.empty() ? "??" : callers.front().c_str() );
+      for( std::size_t i=1UL; i<callers.size(); ++i ) {
+         std::fprintf( file, "%37s<- %s\n", "", callers[i].c_str() );
+      }
+   }
+
+   if( file != stderr ) {
+      std::fclose( file );
+   }
+}
+
+} // namespace
+
+
+std::atomic<bool> heapProfileEnabled{ false };
+
+namespace {
+
+// The profiler is configured during static initialization, i.e. allocations performed during the
+// static initialization of other translation units may not be recorded
+[[maybe_unused]] bool const initialized( []{
+   heapProfileEnabled.store( HeapProfile::instance() != nullptr );
+   return true;
+}() );
+
+} // namespace
+
+
+[[gnu::noinline]] void sampleAllocation( std::size_t size ) noexcept
+{
+#if BENCHMARK_HAS_BACKTRACE
+   if( inProfiler ) return;
+
+   HeapProfile* const profile( HeapProfile::instance() );
+   if( !profile || !profile->sampleNext() ) return;
+
+   inProfiler = true;
+
+   void* frames[maxFrames+skipFrames]{};
+   int const count( ::backtrace( frames, maxFrames+skipFrames ) );
+
+   Stack stack{};
+   for( int i=skipFrames; i<count; ++i ) {
+      stack[static_cast<std::size_t>( i-skipFrames )] = frames[i];
+   }
+
+   try {
+      profile->sample( size, stack );
+   }
+   catch( ... ) {}
+
+   inProfiler = false;
+#else
+   static_cast<void>( size );
+#endif
+}
+
+} // namespace internal
+
+} // namespace benchmark
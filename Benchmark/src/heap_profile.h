@@ -0,0 +1,55 @@
+/**************************************************************************************************
+*
+* \file heap_profile.h
+* \brief C++ Training - Sampling heap profiler of the benchmark harness
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* The heap profiler records the call stack of (every n-th) allocation via the replaced global
+* operator new and aggregates the number of allocations and bytes per call site. It is enabled by
+* setting the environment variable 'BENCHMARK_HEAP_PROFILE' to the name of the report file (or to
+* '-' for stderr); the report is written at program exit:
+*
+*    BENCHMARK_HEAP_PROFILE=- ./CreateStrings_Local --benchmark_repetitions=1
+*
+* The sampling rate is set via 'BENCHMARK_HEAP_PROFILE_RATE' (default: 1, i.e. every allocation);
+* the reported numbers are scaled accordingly. The frames of the harness are skipped, i.e. all
+* allocations of a benchmark are reported for the benchmark function (independent of the phase of
+* the harness), and the allocations of the harness itself are summarized as "(benchmark harness)".
+* Source file and line numbers are only available in case the executable is compiled with debug
+* information ('-g') and 'addr2line' is installed. In case the program terminates abnormally (e.g.
+* via 'std::abort()' after a double free), no report is written.
+*
+**************************************************************************************************/
+
+#ifndef BENCHMARK_HEAP_PROFILE_H
+#define BENCHMARK_HEAP_PROFILE_H
+
+#include <atomic>
+#include <cstddef>
+
+
+namespace benchmark {
+
+namespace internal {
+
+extern std::atomic<bool> heapProfileEnabled;
+
+// Returns whether the heap profiler is enabled (via 'BENCHMARK_HEAP_PROFILE').
+inline bool heapProfiling() noexcept
+{
+   return heapProfileEnabled.load( std::memory_order_relaxed );
+}
+
+// Records an allocation of the given size. The call stack is recorded starting at the caller of
+// the function calling 'sampleAllocation()' (i.e. skipping the allocation function itself).
+void sampleAllocation( std::size_t size ) noexcept;
+
+} // namespace internal
+
+} // namespace benchmark
+
+#endif
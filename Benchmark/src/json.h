@@ -0,0 +1,275 @@
+/**************************************************************************************************
+*
+* \file json.h
+* \brief C++ Training - Minimal JSON parser for benchmark result files
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#ifndef BENCHMARK_JSON_H
+#define BENCHMARK_JSON_H
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace benchmark {
+
+namespace internal {
+
+//---- <Json> -------------------------------------------------------------------------------------
+
+// Minimal JSON value and recursive descent parser, sufficient for the benchmark result files.
+struct Json
+{
+   enum Type { Null, Bool, Number, String, Array, Object };
+
+   Type type{ Null };
+   bool boolean{};
+   double number{};
+   std::string string{};
+   std::vector<Json> array{};
+   std::vector< std::pair<std::string,Json> > object{};
+
+   Json const* find( std::string const& key ) const
+   {
+      for( auto const& [name,value] : object ) {
+         if( name == key ) return &value;
+      }
+      return nullptr;
+   }
+};
+
+
+//---- <JsonParser> -------------------------------------------------------------------------------
+
+class JsonParser
+{
+ public:
+   explicit JsonParser( std::string text )
+      : text_{ std::move(text) }
+   {}
+
+   Json parse()
+   {
+      Json value( parseValue() );
+      skipWhitespace();
+      if( pos_ != text_.size() ) error( "trailing characters" );
+      return value;
+   }
+
+ private:
+   [[noreturn]] void error( char const* message ) const
+   {
+      throw std::runtime_error( std::string( "JSON parse error at offset " ) + std::to_string( pos_ ) + ": " + message );
+   }
+
+   void skipWhitespace()
+   {
+      while( pos_ < text_.size() && std::isspace( static_cast<unsigned char>( text_[pos_] ) ) ) ++pos_;
+   }
+
+   bool consume( char c )
+   {
+      skipWhitespace();
+      if( pos_ < text_.size() && text_[pos_] == c ) {
+         ++pos_;
+         return true;
+      }
+      return false;
+   }
+
+   void expect( char c )
+   {
+      if( !consume( c ) ) error( "unexpected character" );
+   }
+
+   bool consumeKeyword( char const* keyword )
+   {
+      std::size_t const length( std::strlen( keyword ) );
+      if( text_.compare( pos_, length, keyword ) == 0 ) {
+         pos_ += length;
+         return true;
+      }
+      return false;
+   }
+
+   Json parseValue()
+   {
+      skipWhitespace();
+      if( pos_ >= text_.size() ) error( "unexpected end of input" );
+
+      Json value{};
+      char const c( text_[pos_] );
+
+      if( c == '{' ) {
+         value.type = Json::Object;
+         ++pos_;
+         if( consume( '}' ) ) return value;
+         do {
+            skipWhitespace();
+            std::string key( parseString() );
+            expect( ':' );
+            value.object.emplace_back( std::move(key), parseValue() );
+         } while( consume( ',' ) );
+         expect( '}' );
+      }
+      else if( c == '[' ) {
+         value.type = Json::Array;
+         ++pos_;
+         if( consume( ']' ) ) return value;
+         do {
+            value.array.push_back( parseValue() );
+         } while( consume( ',' ) );
+         expect( ']' );
+      }
+      else if( c == '"' ) {
+         value.type = Json::String;
+         value.string = parseString();
+      }
+      else if( consumeKeyword( "true" ) ) {
+         value.type = Json::Bool;
+         value.boolean = true;
+      }
+      else if( consumeKeyword( "false" ) ) {
+         value.type = Json::Bool;
+      }
+      else if( consumeKeyword( "null" ) ) {
+         value.type = Json::Null;
+      }
+      else {
+         char const* begin( text_.c_str() + pos_ );
+         char* end( nullptr );
+         value.type = Json::Number;
+         value.number = std::strtod( begin, &end );
+         if( end == begin ) error( "invalid value" );
+         pos_ += static_cast<std::size_t>( end - begin );
+      }
+
+      return value;
+   }
+
+   std::string parseString()
+   {
+      if( pos_ >= text_.size() || text_[pos_] != '"' ) error( "expected string" );
+      ++pos_;
+
+      std::string result{};
+      while( pos_ < text_.size() && text_[pos_] != '"' )
+      {
+         char c( text_[pos_++] );
+         if( c == '\\' && pos_ < text_.size() ) {
+            c = text_[pos_++];
+            switch( c ) {
+               case 'n': c = '\n'; break;
+               case 't': c = '\t'; break;
+               case 'r': c = '\r'; break;
+               case 'u': pos_ += 4UL; c = '?'; break;  // Non-ASCII names are not expected
+               default: break;
+            }
+         }
+         result.push_back( c );
+      }
+      if( pos_ >= text_.size() ) error( "unterminated string" );
+      ++pos_;
+      return result;
+   }
+
+   std::string text_;
+   std::size_t pos_{};
+};
+
+
+// Reads and parses the given JSON file; throws a 'std::runtime_error' on failure.
+inline Json loadJson( std::string const& filename )
+{
+   std::ifstream file( filename );
+   if( !file ) {
+      throw std::runtime_error( "Unable to open '" + filename + "'" );
+   }
+   std::ostringstream oss{};
+   oss << file.rdbuf();
+
+   return JsonParser{ oss.str() }.parse();
+}
+
+
+//---- Loading of benchmark results ---------------------------------------------------------------
+
+// Returns the per-repetition times (in nanoseconds) of all benchmarks in the given file, in the
+// order of their first appearance.
+inline std::vector< std::pair<std::string,std::vector<double>> > loadSamples( std::string const& filename )
+{
+   Json const root( loadJson( filename ) );
+   Json const* benchmarks( root.find( "benchmarks" ) );
+   if( !benchmarks || benchmarks->type != Json::Array ) {
+      throw std::runtime_error( "'" + filename + "' does not contain benchmark results" );
+   }
+
+   std::vector< std::pair<std::string,std::vector<double>> > result{};
+
+   for( Json const& entry : benchmarks->array )
+   {
+      Json const* runType( entry.find( "run_type" ) );
+      if( runType && runType->string != "iteration" ) continue;
+
+      Json const* name( entry.find( "run_name" ) );
+      if( !name ) name = entry.find( "name" );
+      Json const* time( entry.find( "real_time" ) );
+      Json const* unit( entry.find( "time_unit" ) );
+      if( !name || !time ) continue;
+
+      double factor( 1.0 );
+      if( unit ) {
+         if( unit->string == "us" ) factor = 1E3;
+         if( unit->string == "ms" ) factor = 1E6;
+         if( unit->string == "s"  ) factor = 1E9;
+      }
+
+      auto pos( std::find_if( begin(result), end(result),
+                              [&]( auto const& run ){ return run.first == name->string; } ) );
+      if( pos == end(result) ) {
+         result.emplace_back( name->string, std::vector<double>{} );
+         pos = std::prev( end(result) );
+      }
+      pos->second.push_back( time->number * factor );
+   }
+
+   return result;
+}
+
+// Formats the given time with a suitable unit (e.g. '1.23 ms').
+inline std::string formatTime( double nanoseconds )
+{
+   static constexpr char const* units[] = { "ns", "us", "ms", "s" };
+
+   std::size_t index{};
+   while( nanoseconds >= 1000.0 && index < 3UL ) {
+      nanoseconds /= 1000.0;
+      ++index;
+   }
+
+   std::ostringstream oss{};
+   oss << std::fixed << std::setprecision( 2 ) << nanoseconds << " " << units[index];
+   return oss.str();
+}
+
+} // namespace internal
+
+} // namespace benchmark
+
+#endif
@@ -0,0 +1,106 @@
+/**************************************************************************************************
+*
+* \file latency.cpp
+* \brief C++ Training - Logarithmic latency histogram of the benchmark harness
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+
+
+namespace benchmark {
+
+namespace {
+
+// Values below 'linearValues' have their own bucket. Above, every power of 2 is split into
+// 'subBuckets' linear buckets.
+constexpr uint64_t linearValues( 128U );
+constexpr uint64_t subBuckets( 64U );
+
+std::size_t bucketIndex( int64_t value )
+{
+   uint64_t const v( value > 0 ? static_cast<uint64_t>( value ) : 0U );
+   if( v < linearValues ) return v;
+
+   int const shift( std::bit_width( v ) - 7 );  // Keeps the 7 most significant bits
+   return linearValues + static_cast<uint64_t>( shift - 1 ) * subBuckets + ( ( v >> shift ) - subBuckets );
+}
+
+// Returns the largest value that is recorded in the bucket with the given index.
+int64_t bucketUpperBound( std::size_t index )
+{
+   if( index < linearValues ) return static_cast<int64_t>( index );
+
+   uint64_t const shift( ( index - linearValues ) / subBuckets + 1U );
+   uint64_t const mantissa( ( index - linearValues ) % subBuckets + subBuckets );
+   return static_cast<int64_t>( ( ( mantissa + 1U ) << shift ) - 1U );
+}
+
+} // namespace
+
+
+void LatencyHistogram::record( int64_t nanoseconds )
+{
+   std::size_t const index( bucketIndex( nanoseconds ) );
+   if( index >= counts_.size() ) {
+      counts_.resize( index + 1UL );
+   }
+   ++counts_[index];
+
+   min_ = ( count_ == 0 ) ? nanoseconds : std::min( min_, nanoseconds );
+   max_ = std::max( max_, nanoseconds );
+   ++count_;
+}
+
+void LatencyHistogram::merge( LatencyHistogram const& other )
+{
+   if( other.count_ == 0 ) return;
+
+   if( other.counts_.size() > counts_.size() ) {
+      counts_.resize( other.counts_.size() );
+   }
+   for( std::size_t i=0UL; i<other.counts_.size(); ++i ) {
+      counts_[i] += other.counts_[i];
+   }
+
+   min_ = ( count_ == 0 ) ? other.min_ : std::min( min_, other.min_ );
+   max_ = std::max( max_, other.max_ );
+   count_ += other.count_;
+}
+
+void LatencyHistogram::reset()
+{
+   counts_.clear();
+   count_ = 0;
+   min_ = 0;
+   max_ = 0;
+}
+
+int64_t LatencyHistogram::percentile( double percent ) const
+{
+   if( count_ == 0 ) return 0;
+
+   double const rank( std::ceil( std::clamp( percent, 0.0, 100.0 ) / 100.0 * static_cast<double>( count_ ) ) );
+   int64_t const target( std::max<int64_t>( static_cast<int64_t>( rank ), 1 ) );
+
+   int64_t seen{};
+   for( std::size_t i=0UL; i<counts_.size(); ++i ) {
+      seen += counts_[i];
+      if( seen >= target ) {
+         return std::clamp( bucketUpperBound( i ), min(), max_ );
+      }
+   }
+   return max_;
+}
+
+} // namespace benchmark
@@ -0,0 +1,114 @@
+/**************************************************************************************************
+*
+* \file memory_usage.cpp
+* \brief C++ Training - Resident set size and heap statistics of the benchmark process
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#include <benchmark/benchmark.h>
+#include "memory_usage.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#  include <sys/resource.h>
+#endif
+
+#if defined(__GLIBC__)
+#  include <malloc.h>
+#  include <cstdio>
+#  include <cstdlib>
+#endif
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+
+namespace benchmark {
+
+namespace internal {
+
+bool resetPeakRss()
+{
+#if defined(__linux__)
+   // Writing '5' to 'clear_refs' resets the peak RSS ('VmHWM') to the current RSS
+   std::ofstream clearRefs( "/proc/self/clear_refs" );
+   clearRefs << "5" << std::flush;
+   return static_cast<bool>( clearRefs );
+#else
+   return false;
+#endif
+}
+
+int64_t peakRss()
+{
+#if defined(__linux__)
+   std::ifstream status( "/proc/self/status" );
+   std::string line{};
+   while( std::getline( status, line ) ) {
+      if( line.rfind( "VmHWM:", 0 ) == 0 ) {
+         std::istringstream iss( line.substr( 6UL ) );
+         int64_t kilobytes{};
+         iss >> kilobytes;
+         return kilobytes * 1024;
+      }
+   }
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+   rusage usage{};
+   if( ::getrusage( RUSAGE_SELF, &usage ) == 0 ) {
+#  if defined(__APPLE__)
+      return static_cast<int64_t>( usage.ru_maxrss );  // Bytes on macOS
+#  else
+      return static_cast<int64_t>( usage.ru_maxrss ) * 1024;
+#  endif
+   }
+#endif
+
+   return 0;
+}
+
+} // namespace internal
+
+
+HeapStatistics GetHeapStatistics()
+{
+   HeapStatistics result{};
+
+#if defined(__GLIBC__)
+#  if __GLIBC_PREREQ(2,33)
+   struct mallinfo2 const info( ::mallinfo2() );
+#  else
+   struct mallinfo const info( ::mallinfo() );  // Values wrap around beyond 2GB
+#  endif
+   result.arena      = static_cast<int64_t>( info.arena );
+   result.inUse      = static_cast<int64_t>( info.uordblks );
+   result.free       = static_cast<int64_t>( info.fordblks );
+   result.releasable = static_cast<int64_t>( info.keepcost );
+   result.mmapped    = static_cast<int64_t>( info.hblkhd );
+   result.freeChunks = static_cast<int64_t>( info.ordblks );
+
+   // The number of arenas is only available via the XML output of 'malloc_info()' (one '<heap>'
+   // element per arena)
+   char* buffer{ nullptr };
+   std::size_t size{};
+   if( std::FILE* stream = ::open_memstream( &buffer, &size ) ) {
+      ::malloc_info( 0, stream );
+      std::fclose( stream );
+      std::string const xml( buffer, size );
+      for( std::size_t pos=xml.find( "<heap nr=" ); pos!=std::string::npos; pos=xml.find( "<heap nr=", pos+1UL ) ) {
+         ++result.arenas;
+      }
+   }
+   std::free( buffer );
+#endif
+
+   return result;
+}
+
+} // namespace benchmark
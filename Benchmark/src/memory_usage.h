@@ -0,0 +1,36 @@
+/**************************************************************************************************
+*
+* \file memory_usage.h
+* \brief C++ Training - Resident set size of the benchmark process
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#ifndef BENCHMARK_MEMORY_USAGE_H
+#define BENCHMARK_MEMORY_USAGE_H
+
+#include <cstdint>
+
+
+namespace benchmark {
+
+namespace internal {
+
+// Resets the peak resident set size of the process to the current resident set size. Returns
+// 'false' in case the peak cannot be reset (e.g. on non-Linux platforms or on kernels prior to
+// 4.0), in which case 'peakRss()' returns the peak of the entire process lifetime.
+bool resetPeakRss();
+
+// Returns the peak resident set size in bytes (from 'VmHWM' in '/proc/self/status' or, if not
+// available, from 'getrusage()').
+int64_t peakRss();
+
+} // namespace internal
+
+} // namespace benchmark
+
+#endif
@@ -0,0 +1,169 @@
+/**************************************************************************************************
+*
+* \file perf_counters.cpp
+* \brief C++ Training - Hardware performance counters via the Linux 'perf_event_open()' API
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#include "perf_counters.h"
+
+#if defined(__linux__)
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+
+
+namespace benchmark {
+
+namespace internal {
+
+#if defined(__linux__)
+
+namespace {
+
+struct EventDescription
+{
+   char const* name;
+   uint32_t type;
+   uint64_t config;
+};
+
+constexpr uint64_t cacheConfig( uint64_t cache, uint64_t op, uint64_t result )
+{
+   return cache | ( op << 8 ) | ( result << 16 );
+}
+
+// The first event is the group leader; it has to be supported for any counter to be reported
+constexpr EventDescription events[] = {
+   { "cycles"       , PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+   { "instructions" , PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+   { "L1D-misses"   , PERF_TYPE_HW_CACHE, cacheConfig( PERF_COUNT_HW_CACHE_L1D
+                                                     , PERF_COUNT_HW_CACHE_OP_READ
+                                                     , PERF_COUNT_HW_CACHE_RESULT_MISS ) },
+   { "LLC-misses"   , PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+   { "branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+};
+
+int openEvent( EventDescription const& event, int groupFd )
+{
+   perf_event_attr attr{};
+   attr.size = sizeof(attr);
+   attr.type = event.type;
+   attr.config = event.config;
+   attr.disabled = ( groupFd == -1 ) ? 1 : 0;
+   attr.exclude_kernel = 1;
+   attr.exclude_hv = 1;
+   attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+   return static_cast<int>( ::syscall( SYS_perf_event_open, &attr, 0, -1, groupFd, 0UL ) );
+}
+
+} // namespace
+
+
+std::unique_ptr<PerfCounters> PerfCounters::create()
+{
+   std::unique_ptr<PerfCounters> counters( new PerfCounters{} );
+
+   for( auto const& event : events )
+   {
+      int const fd( openEvent( event, counters->leader_ ) );
+
+      if( fd == -1 ) {
+         if( counters->leader_ == -1 ) return nullptr;
+         continue;
+      }
+      if( counters->leader_ == -1 ) {
+         counters->leader_ = fd;
+      }
+
+      counters->fds_.push_back( fd );
+      counters->names_.push_back( event.name );
+   }
+
+   counters->totals_.resize( counters->fds_.size() );
+   return counters;
+}
+
+PerfCounters::~PerfCounters()
+{
+   for( int const fd : fds_ ) {
+      ::close( fd );
+   }
+}
+
+void PerfCounters::start()
+{
+   if( running_ ) return;
+
+   ::ioctl( leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP );
+   ::ioctl( leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP );
+   running_ = true;
+}
+
+void PerfCounters::stop()
+{
+   if( !running_ ) return;
+
+   ::ioctl( leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP );
+   running_ = false;
+
+   // Layout of the group read: { nr, time_enabled, time_running, value[nr] }
+   std::vector<uint64_t> buffer( 3UL + fds_.size() );
+   ssize_t const bytes( ::read( leader_, buffer.data(), buffer.size() * sizeof(uint64_t) ) );
+   if( bytes < static_cast<ssize_t>( 3UL * sizeof(uint64_t) ) || buffer[0] != fds_.size() ) {
+      return;
+   }
+
+   // Scale the counts in case the kernel had to multiplex the counters
+   double const enabled( static_cast<double>( buffer[1] ) );
+   double const running( static_cast<double>( buffer[2] ) );
+   double const scale( running > 0.0 ? enabled / running : 1.0 );
+
+   for( std::size_t i=0UL; i<fds_.size(); ++i ) {
+      totals_[i] += static_cast<double>( buffer[3UL+i] ) * scale;
+   }
+}
+
+#else
+
+std::unique_ptr<PerfCounters> PerfCounters::create()
+{
+   return nullptr;
+}
+
+PerfCounters::~PerfCounters() = default;
+
+void PerfCounters::start() {}
+void PerfCounters::stop() {}
+
+#endif
+
+
+void PerfCounters::reset()
+{
+   std::fill( totals_.begin(), totals_.end(), 0.0 );
+}
+
+std::vector< std::pair<std::string,double> > PerfCounters::values() const
+{
+   std::vector< std::pair<std::string,double> > result{};
+   for( std::size_t i=0UL; i<names_.size(); ++i ) {
+      result.emplace_back( names_[i], totals_[i] );
+   }
+   return result;
+}
+
+} // namespace internal
+
+} // namespace benchmark
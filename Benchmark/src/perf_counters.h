@@ -0,0 +1,63 @@
+/**************************************************************************************************
+*
+* \file perf_counters.h
+* \brief C++ Training - Hardware performance counters via the Linux 'perf_event_open()' API
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#ifndef BENCHMARK_PERF_COUNTERS_H
+#define BENCHMARK_PERF_COUNTERS_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace benchmark {
+
+namespace internal {
+
+//---- <PerfCounters> -----------------------------------------------------------------------------
+
+// Group of hardware counters (cycles, instructions, L1D/LLC misses, branch misses) of the calling
+// thread. Counters that are not supported by the CPU (or by the virtual machine) are skipped. In
+// case no counter at all can be opened (e.g. due to '/proc/sys/kernel/perf_event_paranoid' or on
+// non-Linux platforms), 'create()' returns a nullptr.
+class PerfCounters
+{
+ public:
+   static std::unique_ptr<PerfCounters> create();
+
+   ~PerfCounters();
+   PerfCounters( PerfCounters const& ) = delete;
+   PerfCounters& operator=( PerfCounters const& ) = delete;
+
+   void start();
+   void stop();
+   void reset();
+
+   // Returns the accumulated (multiplexing corrected) counts of all opened counters.
+   std::vector< std::pair<std::string,double> > values() const;
+
+ private:
+   PerfCounters() = default;
+
+   int leader_{ -1 };
+   std::vector<int> fds_{};
+   std::vector<std::string> names_{};
+   std::vector<double> totals_{};
+   bool running_{ false };
+};
+
+} // namespace internal
+
+} // namespace benchmark
+
+#endif
@@ -0,0 +1,38 @@
+/**************************************************************************************************
+*
+* \file program_main.cpp
+* \brief C++ Training - Benchmark of the 'main()' function of an ordinary program
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* Runs an ordinary program under the benchmark harness: the 'main()' function of the program is
+* renamed to 'benchmarkedMain()' (by compiling the program with '-Dmain=benchmarkedMain') and is
+* executed once per iteration of the benchmark 'program'.
+*
+**************************************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+
+
+int benchmarkedMain();
+
+
+static void program( benchmark::State& state )
+{
+   for( auto _ : state )
+   {
+      int const result( benchmarkedMain() );
+      if( result != EXIT_SUCCESS ) {
+         std::exit( result );
+      }
+   }
+}
+BENCHMARK(program);
+
+
+BENCHMARK_MAIN();
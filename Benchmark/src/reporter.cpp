@@ -0,0 +1,362 @@
+/**************************************************************************************************
+*
+* \file reporter.cpp
+* \brief C++ Training - Console, JSON and CSV output of the benchmark harness
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#include "reporter.h"
+#include "statistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <thread>
+
+
+namespace benchmark {
+
+namespace internal {
+
+std::vector<double> times( Run const& run )
+{
+   std::vector<double> result{};
+   for( auto const& repetition : run.repetitions ) {
+      result.push_back( repetition.seconds );
+   }
+   return result;
+}
+
+Counters aggregate( Run const& run, double (*statistic)( std::vector<double> const& ) )
+{
+   if( run.repetitions.empty() ) return Counters{};
+
+   Counters result( run.repetitions.front().counters );
+   for( std::size_t i=0UL; i<result.size(); ++i ) {
+      std::vector<double> values{};
+      for( auto const& repetition : run.repetitions ) {
+         values.push_back( repetition.counters[i].second );
+      }
+      result[i].second = statistic( values );
+   }
+   return result;
+}
+
+
+namespace {
+
+constexpr double unitFactors[] = { 1E9, 1E6, 1E3, 1.0 };
+constexpr char const* unitNames[] = { "ns", "us", "ms", "s" };
+
+
+//---- <ConsoleReporter> --------------------------------------------------------------------------
+
+class ConsoleReporter : public Reporter
+{
+ public:
+   ConsoleReporter( std::ostream& os, bool aggregatesOnly )
+      : os_            { os }
+      , aggregatesOnly_{ aggregatesOnly }
+   {}
+
+   void reportContext( std::string const& program, std::size_t nameWidth ) override
+   {
+      nameWidth_ = std::max( nameWidth_, static_cast<int>( nameWidth ) + 1 );
+      std::string const line( static_cast<std::size_t>( nameWidth_ + 32 ), '-' );
+
+      os_ << "Running " << program << "\n"
+          << "Run on (" << std::thread::hardware_concurrency() << " X CPU)\n"
+          << line << "\n"
+          << std::left << std::setw( nameWidth_ ) << "Benchmark"
+          << std::right << std::setw( 16 ) << "Time"
+          << std::setw( 16 ) << "Iterations" << "\n"
+          << line << "\n";
+   }
+
+   void reportRun( Run const& run ) override
+   {
+      if( !aggregatesOnly_ || run.repetitions.size() == 1UL ) {
+         for( auto const& repetition : run.repetitions ) {
+            printLine( run.name, repetition.seconds, run.unit, std::to_string( run.iterations ),
+                       repetition.counters );
+         }
+      }
+
+      if( run.repetitions.size() > 1UL ) {
+         std::string const reps( std::to_string( run.repetitions.size() ) );
+         printLine( run.name + "_mean"  , mean  ( times( run ) ), run.unit, reps, aggregate( run, mean   ) );
+         printLine( run.name + "_median", median( times( run ) ), run.unit, reps, aggregate( run, median ) );
+         printLine( run.name + "_stddev", stddev( times( run ) ), run.unit, reps, Counters{} );
+         printLine( run.name + "_cv"    , cv    ( times( run ) ), run.unit, reps, Counters{}, true );
+         printLine( run.name + "_min"   , minimum( times( run ) ), run.unit, reps, aggregate( run, minimum ) );
+         printLine( run.name + "_p95"   , p95   ( times( run ) ), run.unit, reps, aggregate( run, p95    ) );
+      }
+
+      if( run.noisy ) {
+         os_ << "WARNING: '" << run.name << "' is too noisy to be trusted (cv = "
+             << formatPercent( cv( times( run ) ) ) << ")\n" << std::flush;
+      }
+   }
+
+   void finalize() override {}
+
+ private:
+   static std::string formatTime( double seconds, TimeUnit unit )
+   {
+      std::ostringstream oss{};
+      oss << std::fixed << std::setprecision( 2 ) << seconds * unitFactors[unit] << " " << unitNames[unit];
+      return oss.str();
+   }
+
+   // Formats the given value with a 'k', 'M' or 'G' suffix (e.g. '900.02k').
+   static std::string formatCounter( double value )
+   {
+      static constexpr char const* suffixes[] = { "", "k", "M", "G" };
+
+      std::size_t index{};
+      while( std::abs( value ) >= 1000.0 && index < 3UL ) {
+         value /= 1000.0;
+         ++index;
+      }
+
+      std::ostringstream oss{};
+      oss << std::setprecision( 5 ) << value << suffixes[index];
+      return oss.str();
+   }
+
+   static std::string formatPercent( double ratio )
+   {
+      std::ostringstream oss{};
+      oss << std::fixed << std::setprecision( 2 ) << ratio * 100.0 << " %";
+      return oss.str();
+   }
+
+   void printLine( std::string const& name, double time, TimeUnit unit,
+                   std::string const& iterations, Counters const& counters, bool percent = false )
+   {
+      os_ << std::left << std::setw( nameWidth_ ) << name
+          << std::right << std::setw( 16 ) << ( percent ? formatPercent( time ) : formatTime( time, unit ) )
+          << std::setw( 16 ) << iterations;
+      for( auto const& [counter,value] : counters ) {
+         os_ << " " << counter << "=" << formatCounter( value );
+      }
+      os_ << "\n" << std::flush;
+   }
+
+   std::ostream& os_;
+   bool aggregatesOnly_{};
+   int nameWidth_{ 40 };
+};
+
+
+//---- <JsonReporter> -----------------------------------------------------------------------------
+
+// Writes the results in the JSON format of Google Benchmark. Each repetition is written as an
+// individual "iteration" entry, followed by the "aggregate" entries (mean, median, stddev, min,
+// p95, cv). As in Google Benchmark, the coefficient of variation is given as a fraction.
+class JsonReporter : public Reporter
+{
+ public:
+   explicit JsonReporter( std::ostream& os )
+      : os_{ os }
+   {}
+
+   void reportContext( std::string const& program, std::size_t ) override
+   {
+      char date[64]{};
+      std::time_t const now( std::time( nullptr ) );
+      std::strftime( date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime( &now ) );
+
+      os_ << "{\n"
+          << "  \"context\": {\n"
+          << "    \"date\": " << quote( date ) << ",\n"
+          << "    \"executable\": " << quote( program ) << ",\n"
+          << "    \"num_cpus\": " << std::thread::hardware_concurrency() << "\n"
+          << "  },\n"
+          << "  \"benchmarks\": [";
+   }
+
+   void reportRun( Run const& run ) override
+   {
+      for( std::size_t i=0UL; i<run.repetitions.size(); ++i ) {
+         writeEntry( run, run.name, "iteration", nullptr, i, run.repetitions[i].seconds,
+                     run.repetitions[i].counters );
+      }
+
+      if( run.repetitions.size() > 1UL ) {
+         writeEntry( run, run.name + "_mean"  , "aggregate", "mean"  , 0UL, mean  ( times( run ) ), aggregate( run, mean   ) );
+         writeEntry( run, run.name + "_median", "aggregate", "median", 0UL, median( times( run ) ), aggregate( run, median ) );
+         writeEntry( run, run.name + "_stddev", "aggregate", "stddev", 0UL, stddev( times( run ) ), Counters{} );
+         writeEntry( run, run.name + "_cv"    , "aggregate", "cv"    , 0UL, cv    ( times( run ) ), Counters{} );
+         writeEntry( run, run.name + "_min"   , "aggregate", "min"   , 0UL, minimum( times( run ) ), aggregate( run, minimum ) );
+         writeEntry( run, run.name + "_p95"   , "aggregate", "p95"   , 0UL, p95   ( times( run ) ), aggregate( run, p95    ) );
+      }
+   }
+
+   void finalize() override
+   {
+      os_ << "\n  ]\n}\n" << std::flush;
+   }
+
+ private:
+   static std::string quote( std::string const& text )
+   {
+      std::ostringstream oss{};
+      oss << '"';
+      for( char const c : text ) {
+         switch( c ) {
+            case '"' : oss << "\\\""; break;
+            case '\\': oss << "\\\\"; break;
+            case '\n': oss << "\\n";  break;
+            case '\t': oss << "\\t";  break;
+            default:   oss << c;      break;
+         }
+      }
+      oss << '"';
+      return oss.str();
+   }
+
+   void writeEntry( Run const& run, std::string const& name, char const* runType,
+                    char const* aggregateName, std::size_t index, double seconds,
+                    Counters const& counters )
+   {
+      os_ << ( first_ ? "\n" : ",\n" ) << "    {\n"
+          << "      \"name\": " << quote( name ) << ",\n"
+          << "      \"run_name\": " << quote( run.name ) << ",\n"
+          << "      \"run_type\": " << quote( runType ) << ",\n"
+          << "      \"repetitions\": " << run.repetitions.size() << ",\n";
+      if( aggregateName ) {
+         os_ << "      \"aggregate_name\": " << quote( aggregateName ) << ",\n";
+         if( std::strcmp( aggregateName, "cv" ) == 0 ) {
+            os_ << "      \"aggregate_unit\": \"percentage\",\n";
+         }
+      }
+      os_ << "      \"repetition_index\": " << index << ",\n";
+      if( run.noisy ) {
+         os_ << "      \"noisy\": true,\n";
+      }
+      bool const percent( aggregateName && std::strcmp( aggregateName, "cv" ) == 0 );
+      os_ << "      \"iterations\": " << run.iterations << ",\n"
+          << "      \"real_time\": " << std::setprecision( 17 ) << ( percent ? seconds : seconds * unitFactors[run.unit] ) << ",\n";
+      for( auto const& [counter,value] : counters ) {
+         os_ << "      " << quote( counter ) << ": " << value << ",\n";
+      }
+      os_ << "      \"time_unit\": " << quote( unitNames[run.unit] ) << "\n"
+          << "    }";
+      first_ = false;
+   }
+
+   std::ostream& os_;
+   bool first_{ true };
+};
+
+
+
+//---- <CsvReporter> ------------------------------------------------------------------------------
+
+// Writes one line per repetition and aggregate, including one column per benchmark argument and
+// per counter. Since different benchmarks may have different arguments and counters, a new header
+// line is written whenever the set of columns changes.
+class CsvReporter : public Reporter
+{
+ public:
+   explicit CsvReporter( std::ostream& os )
+      : os_{ os }
+   {}
+
+   void reportContext( std::string const&, std::size_t ) override {}
+
+   void reportRun( Run const& run ) override
+   {
+      std::string header( "name,run_type" );
+      for( std::size_t i=0UL; i<run.args.size(); ++i ) {
+         header += ",arg" + std::to_string( i );
+      }
+      header += ",iterations,real_time,time_unit";
+      if( !run.repetitions.empty() ) {
+         for( auto const& counter : run.repetitions.front().counters ) {
+            header += "," + quote( counter.first );
+         }
+      }
+      if( header != header_ ) {
+         os_ << header << "\n";
+         header_ = header;
+      }
+
+      for( auto const& repetition : run.repetitions ) {
+         writeLine( run, run.name, "iteration", repetition.seconds, repetition.counters );
+      }
+
+      if( run.repetitions.size() > 1UL ) {
+         writeLine( run, run.name + "_mean"  , "mean"  , mean  ( times( run ) ), aggregate( run, mean   ) );
+         writeLine( run, run.name + "_median", "median", median( times( run ) ), aggregate( run, median ) );
+         writeLine( run, run.name + "_stddev", "stddev", stddev( times( run ) ), aggregate( run, stddev ) );
+         writeLine( run, run.name + "_cv"    , "cv"    , cv    ( times( run ) ), aggregate( run, cv     ), true );
+         writeLine( run, run.name + "_min"   , "min"   , minimum( times( run ) ), aggregate( run, minimum ) );
+         writeLine( run, run.name + "_p95"   , "p95"   , p95   ( times( run ) ), aggregate( run, p95    ) );
+      }
+      os_ << std::flush;
+   }
+
+   void finalize() override {}
+
+ private:
+   static std::string quote( std::string const& text )
+   {
+      std::string result( "\"" );
+      for( char const c : text ) {
+         if( c == '"' ) result += '"';
+         result += c;
+      }
+      return result + "\"";
+   }
+
+   void writeLine( Run const& run, std::string const& name, char const* runType, double seconds,
+                   Counters const& counters, bool fraction = false )
+   {
+      os_ << quote( name ) << "," << runType;
+      for( int64_t const arg : run.args ) {
+         os_ << "," << arg;
+      }
+      os_ << "," << run.iterations << "," << std::setprecision( 10 )
+          << ( fraction ? seconds : seconds * unitFactors[run.unit] ) << "," << unitNames[run.unit];
+      for( auto const& counter : counters ) {
+         os_ << "," << counter.second;
+      }
+      os_ << "\n";
+   }
+
+   std::ostream& os_;
+   std::string header_{};
+};
+
+} // namespace
+
+
+std::unique_ptr<Reporter> makeConsoleReporter( std::ostream& os, bool aggregatesOnly )
+{
+   return std::make_unique<ConsoleReporter>( os, aggregatesOnly );
+}
+
+std::unique_ptr<Reporter> makeJsonReporter( std::ostream& os )
+{
+   return std::make_unique<JsonReporter>( os );
+}
+
+std::unique_ptr<Reporter> makeCsvReporter( std::ostream& os )
+{
+   return std::make_unique<CsvReporter>( os );
+}
+
+} // namespace internal
+
+} // namespace benchmark
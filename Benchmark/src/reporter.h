@@ -0,0 +1,82 @@
+/**************************************************************************************************
+*
+* \file reporter.h
+* \brief C++ Training - Console, JSON and CSV output of the benchmark harness
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#ifndef BENCHMARK_REPORTER_H
+#define BENCHMARK_REPORTER_H
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace benchmark {
+
+namespace internal {
+
+using Counters = std::vector< std::pair<std::string,double> >;
+
+
+//---- <Run> --------------------------------------------------------------------------------------
+
+// Result of a single repetition (time and counters per iteration).
+struct Repetition
+{
+   double seconds{};
+   Counters counters{};
+};
+
+// Result of all repetitions of a single benchmark.
+struct Run
+{
+   std::string name{};
+   std::vector<int64_t> args{};
+   int64_t iterations{};
+   TimeUnit unit{ kNanosecond };
+   std::vector<Repetition> repetitions{};
+   bool noisy{ false };  // Coefficient of variation above the threshold ('--benchmark_max_cv')
+};
+
+std::vector<double> times( Run const& run );
+
+// Applies the given statistic (mean, median, ...) to each counter of all repetitions.
+Counters aggregate( Run const& run, double (*statistic)( std::vector<double> const& ) );
+
+
+//---- <Reporter> ---------------------------------------------------------------------------------
+
+class Reporter
+{
+ public:
+   virtual ~Reporter() = default;
+
+   // Called once before the first run; 'nameWidth' is the length of the longest benchmark name
+   // (including the '_median' suffix).
+   virtual void reportContext( std::string const& program, std::size_t nameWidth ) = 0;
+   virtual void reportRun( Run const& run ) = 0;
+   virtual void finalize() = 0;
+};
+
+std::unique_ptr<Reporter> makeConsoleReporter( std::ostream& os, bool aggregatesOnly );
+std::unique_ptr<Reporter> makeJsonReporter( std::ostream& os );
+std::unique_ptr<Reporter> makeCsvReporter( std::ostream& os );
+
+} // namespace internal
+
+} // namespace benchmark
+
+#endif
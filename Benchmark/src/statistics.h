@@ -0,0 +1,151 @@
+/**************************************************************************************************
+*
+* \file statistics.h
+* \brief C++ Training - Statistical functions of the benchmark harness
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#ifndef BENCHMARK_STATISTICS_H
+#define BENCHMARK_STATISTICS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+
+namespace benchmark {
+
+namespace internal {
+
+inline double mean( std::vector<double> const& values )
+{
+   if( values.empty() ) return 0.0;
+   return std::accumulate( begin(values), end(values), 0.0 ) / static_cast<double>( values.size() );
+}
+
+inline double median( std::vector<double> const& values )
+{
+   if( values.empty() ) return 0.0;
+
+   std::vector<double> sorted( values );
+   std::sort( begin(sorted), end(sorted) );
+   std::size_t const n( sorted.size() );
+   return ( n % 2UL == 1UL ) ? sorted[n/2UL] : 0.5 * ( sorted[n/2UL-1UL] + sorted[n/2UL] );
+}
+
+inline double minimum( std::vector<double> const& values )
+{
+   if( values.empty() ) return 0.0;
+   return *std::min_element( begin(values), end(values) );
+}
+
+// Returns the given percentile (0.0 <= p <= 1.0), linearly interpolated between the closest ranks.
+inline double percentile( std::vector<double> const& values, double p )
+{
+   if( values.empty() ) return 0.0;
+
+   std::vector<double> sorted( values );
+   std::sort( begin(sorted), end(sorted) );
+   double const position( p * static_cast<double>( sorted.size() - 1UL ) );
+   std::size_t const index( static_cast<std::size_t>( position ) );
+   if( index + 1UL >= sorted.size() ) return sorted.back();
+   return sorted[index] + ( position - static_cast<double>( index ) ) * ( sorted[index+1UL] - sorted[index] );
+}
+
+inline double p95( std::vector<double> const& values )
+{
+   return percentile( values, 0.95 );
+}
+
+inline double stddev( std::vector<double> const& values )
+{
+   if( values.size() < 2UL ) return 0.0;
+
+   double const m( mean( values ) );
+   double sum{};
+   for( double const value : values ) {
+      sum += ( value - m ) * ( value - m );
+   }
+   return std::sqrt( sum / static_cast<double>( values.size() - 1UL ) );
+}
+
+// Coefficient of variation, i.e. the standard deviation relative to the mean.
+inline double cv( std::vector<double> const& values )
+{
+   double const m( mean( values ) );
+   return m > 0.0 ? stddev( values ) / m : 0.0;
+}
+
+
+//---- Mann-Whitney U test ------------------------------------------------------------------------
+
+struct MannWhitneyResult
+{
+   double u{};       // U statistic of the first sample
+   double z{};       // Normal approximation of U (including tie correction)
+   double pvalue{};  // Two-sided p-value
+};
+
+// Two-sided Mann-Whitney U test (aka Wilcoxon rank-sum test) for the null hypothesis that both
+// samples stem from the same distribution. The p-value is computed via the normal approximation
+// with tie and continuity correction, which is reasonable for at least 4-5 samples per side.
+inline MannWhitneyResult mannWhitneyU( std::vector<double> const& a, std::vector<double> const& b )
+{
+   std::size_t const n1( a.size() );
+   std::size_t const n2( b.size() );
+   if( n1 == 0UL || n2 == 0UL ) return MannWhitneyResult{ 0.0, 0.0, 1.0 };
+
+   struct Sample { double value; bool first; };
+   std::vector<Sample> samples{};
+   for( double const v : a ) samples.push_back( Sample{ v, true  } );
+   for( double const v : b ) samples.push_back( Sample{ v, false } );
+   std::sort( begin(samples), end(samples),
+              []( Sample const& lhs, Sample const& rhs ){ return lhs.value < rhs.value; } );
+
+   // Assign average ranks to ties and accumulate the tie correction term
+   double rankSum{};
+   double tieTerm{};
+   for( std::size_t i=0UL; i<samples.size(); )
+   {
+      std::size_t j( i );
+      while( j < samples.size() && samples[j].value == samples[i].value ) ++j;
+
+      double const rank( 0.5 * static_cast<double>( i + j + 1UL ) );
+      for( std::size_t k=i; k<j; ++k ) {
+         if( samples[k].first ) rankSum += rank;
+      }
+
+      double const t( static_cast<double>( j - i ) );
+      tieTerm += t*t*t - t;
+      i = j;
+   }
+
+   double const N1( static_cast<double>( n1 ) );
+   double const N2( static_cast<double>( n2 ) );
+   double const N( N1 + N2 );
+
+   double const u( rankSum - N1 * ( N1 + 1.0 ) / 2.0 );
+   double const mu( N1 * N2 / 2.0 );
+   double const sigma( std::sqrt( N1 * N2 / 12.0 * ( ( N + 1.0 ) - tieTerm / ( N * ( N - 1.0 ) ) ) ) );
+
+   if( sigma == 0.0 ) return MannWhitneyResult{ u, 0.0, 1.0 };
+
+   double const diff( std::abs( u - mu ) - 0.5 );
+   double const z( std::max( diff, 0.0 ) / sigma * ( u < mu ? -1.0 : 1.0 ) );
+   double const pvalue( std::erfc( std::abs( z ) / std::sqrt( 2.0 ) ) );
+
+   return MannWhitneyResult{ u, z, pvalue };
+}
+
+} // namespace internal
+
+} // namespace benchmark
+
+#endif
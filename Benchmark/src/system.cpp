@@ -0,0 +1,103 @@
+/**************************************************************************************************
+*
+* \file system.cpp
+* \brief C++ Training - CPU, frequency scaling and cache settings of the benchmark process
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#include "system.h"
+
+#include <benchmark/benchmark.h>
+
+#if defined(__linux__)
+#  include <sched.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+
+namespace benchmark {
+
+namespace internal {
+
+bool pinThread( [[maybe_unused]] int cpu )
+{
+#if defined(__linux__)
+   if( cpu < 0 || cpu >= CPU_SETSIZE ) return false;
+
+   cpu_set_t set{};
+   CPU_ZERO( &set );
+   CPU_SET( cpu, &set );
+   return ::sched_setaffinity( 0, sizeof(set), &set ) == 0;
+#else
+   return false;
+#endif
+}
+
+std::string cpuGovernor( int cpu )
+{
+   std::ifstream file( "/sys/devices/system/cpu/cpu" + std::to_string( cpu ) + "/cpufreq/scaling_governor" );
+   std::string governor{};
+   file >> governor;
+   return governor;
+}
+
+std::size_t llcSize()
+{
+   // Find the cache of the highest level of CPU 0 (e.g. '/sys/.../index3/size' contains '32768K')
+   std::size_t size{};
+   int level{};
+
+   for( int index=0; ; ++index )
+   {
+      std::string const path( "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string( index ) + "/" );
+      std::ifstream levelFile( path + "level" );
+      std::ifstream sizeFile( path + "size" );
+      if( !levelFile || !sizeFile ) break;
+
+      int cacheLevel{};
+      std::size_t cacheSize{};
+      char suffix{};
+      levelFile >> cacheLevel;
+      sizeFile >> cacheSize >> suffix;
+      if( suffix == 'K' ) cacheSize *= 1024UL;
+      if( suffix == 'M' ) cacheSize *= 1024UL * 1024UL;
+
+      if( cacheLevel >= level ) {
+         level = cacheLevel;
+         size = cacheSize;
+      }
+   }
+
+   return size;
+}
+
+void evictCache()
+{
+   // Twice the size of the LLC (at least 64 MiB in case the size is unknown or suspiciously small).
+   // The buffer is released afterwards to not distort the resident set size of the benchmark.
+   std::vector<uint64_t> buffer(
+      std::max<std::size_t>( 2UL * llcSize(), 64UL * 1024UL * 1024UL ) / sizeof(uint64_t) );
+
+   constexpr std::size_t stride( 64UL / sizeof(uint64_t) );  // One access per cache line
+
+   uint64_t sum{};
+   for( std::size_t i=0UL; i<buffer.size(); i+=stride ) {
+      buffer[i] += 1U;
+      sum += buffer[i];
+   }
+   DoNotOptimize( sum );
+   ClobberMemory();
+}
+
+} // namespace internal
+
+} // namespace benchmark
@@ -0,0 +1,42 @@
+/**************************************************************************************************
+*
+* \file system.h
+* \brief C++ Training - CPU, frequency scaling and cache settings of the benchmark process
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#ifndef BENCHMARK_SYSTEM_H
+#define BENCHMARK_SYSTEM_H
+
+#include <cstddef>
+#include <string>
+
+
+namespace benchmark {
+
+namespace internal {
+
+// Pins the calling thread to the given CPU (via 'sched_setaffinity()'). Returns 'false' in case
+// the CPU does not exist, is not available to the process, or pinning is not supported.
+bool pinThread( int cpu );
+
+// Returns the cpufreq scaling governor of the given CPU (e.g. "performance" or "powersave"), or
+// an empty string in case it cannot be determined (e.g. inside a virtual machine).
+std::string cpuGovernor( int cpu );
+
+// Returns the size in bytes of the last-level cache (or 0 in case it cannot be determined).
+std::size_t llcSize();
+
+// Evicts the last-level cache by streaming through a buffer twice the size of the cache.
+void evictCache();
+
+} // namespace internal
+
+} // namespace benchmark
+
+#endif
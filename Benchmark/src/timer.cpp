@@ -0,0 +1,83 @@
+/**************************************************************************************************
+*
+* \file timer.cpp
+* \brief C++ Training - Time source of the benchmark harness (steady clock or TSC)
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#include "timer.h"
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <string>
+
+
+namespace benchmark {
+
+namespace internal {
+
+namespace {
+
+// Checks the CPU flags for an invariant TSC, i.e. a TSC that ticks with a constant frequency
+// independent of frequency scaling and that does not stop in deep sleep states.
+bool hasInvariantTsc()
+{
+#if BENCHMARK_HAS_TSC
+   std::ifstream cpuinfo( "/proc/cpuinfo" );
+   std::string line{};
+   while( std::getline( cpuinfo, line ) ) {
+      if( line.rfind( "flags", 0 ) == 0 ) {
+         return line.find( " constant_tsc" ) != std::string::npos &&
+                line.find( " nonstop_tsc" ) != std::string::npos;
+      }
+   }
+#endif
+   return false;
+}
+
+} // namespace
+
+
+bool Timer::useTsc()
+{
+   if( tsc_ ) return true;
+   if( !hasInvariantTsc() ) return false;
+
+#if BENCHMARK_HAS_TSC
+   // Calibrate the TSC frequency against the steady clock over ~20ms
+   using Clock = std::chrono::steady_clock;
+
+   Clock::time_point const start( Clock::now() );
+   uint64_t const first( __rdtsc() );
+   while( Clock::now() - start < std::chrono::milliseconds( 20 ) ) {}
+   uint64_t const last( __rdtsc() );
+   Clock::time_point const stop( Clock::now() );
+
+   double const elapsed( std::chrono::duration<double>( stop - start ).count() );
+   secondsPerTick_ = elapsed / static_cast<double>( last - first );
+   tsc_ = true;
+#endif
+
+   return tsc_;
+}
+
+double Timer::overhead()
+{
+   uint64_t minimum( std::numeric_limits<uint64_t>::max() );
+   for( int i=0; i<1000; ++i ) {
+      uint64_t const start( now() );
+      uint64_t const stop( now() );
+      minimum = std::min( minimum, stop - start );
+   }
+   return seconds( minimum );
+}
+
+} // namespace internal
+
+} // namespace benchmark
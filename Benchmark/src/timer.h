@@ -0,0 +1,69 @@
+/**************************************************************************************************
+*
+* \file timer.h
+* \brief C++ Training - Time source of the benchmark harness (steady clock or TSC)
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#ifndef BENCHMARK_TIMER_H
+#define BENCHMARK_TIMER_H
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  include <x86intrin.h>
+#  define BENCHMARK_HAS_TSC 1
+#else
+#  define BENCHMARK_HAS_TSC 0
+#endif
+
+
+namespace benchmark {
+
+namespace internal {
+
+//---- <Timer> ------------------------------------------------------------------------------------
+
+// Time source used for all measurements. By default, 'std::chrono::steady_clock' is used. On x86
+// CPUs with an invariant time stamp counter, the TSC can be selected instead ('useTsc()'), which
+// is read with considerably less overhead and a finer resolution. The frequency of the TSC is
+// calibrated against the steady clock.
+class Timer
+{
+ public:
+   // Switches to the TSC; returns 'false' (and keeps the steady clock) in case the CPU does not
+   // provide an invariant TSC.
+   static bool useTsc();
+   static bool usesTsc() { return tsc_; }
+
+   static uint64_t now()
+   {
+#if BENCHMARK_HAS_TSC
+      if( tsc_ ) return __rdtsc();
+#endif
+      return static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>(
+         std::chrono::steady_clock::now().time_since_epoch() ).count() );
+   }
+
+   static double seconds( uint64_t ticks ) { return static_cast<double>( ticks ) * secondsPerTick_; }
+
+   // Returns the (calibrated, minimum) time in seconds between two consecutive calls to 'now()',
+   // i.e. the overhead included in every timed interval.
+   static double overhead();
+
+ private:
+   static inline bool tsc_{ false };
+   static inline double secondsPerTick_{ 1E-9 };
+};
+
+} // namespace internal
+
+} // namespace benchmark
+
+#endif
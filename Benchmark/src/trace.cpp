@@ -0,0 +1,494 @@
+/**************************************************************************************************
+*
+* \file trace.cpp
+* \brief C++ Training - Trace recorder for special member function calls
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#include <benchmark/trace.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  include <x86intrin.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+
+namespace benchmark {
+
+namespace trace {
+
+namespace {
+
+//---- <Ticks> ------------------------------------------------------------------------------------
+
+// Returns the current timestamp in ticks of the time stamp counter (TSC) or, in case the TSC is not
+// available, in nanoseconds of the steady clock. The ticks are converted to microseconds only when
+// the trace is written.
+inline uint64_t ticks() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+   return __rdtsc();
+#else
+   return static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch() ).count() );
+#endif
+}
+
+
+//---- <Event> ------------------------------------------------------------------------------------
+
+struct Event
+{
+   enum Kind : uint8_t { Construct, Assign, Destroy, ScopeBegin, ScopeEnd };
+
+   char const* name;    // Name of the special member function (also identifies the type)
+   char const* scope;
+   void const* object;
+   uint64_t ticks;      // Timestamp (see 'ticks()')
+   uint32_t thread;
+   Kind kind;
+};
+
+
+//---- <EventBuffer> ------------------------------------------------------------------------------
+
+// Lock-free single-producer/single-consumer ring buffer of the events of a single thread. The
+// owning thread is the only producer; the events are consumed (under the lock of the recorder)
+// by the background drain thread and by 'Recorder::write()'. In case the buffer is full, the
+// event is dropped (and counted) instead of blocking the recording thread.
+class EventBuffer
+{
+ public:
+   static constexpr uint64_t capacity = 1UL << 16;
+
+   explicit EventBuffer( uint32_t thread )
+      : thread_{ thread }
+      , events_{ new Event[capacity] }
+   {}
+
+   uint32_t thread() const noexcept { return thread_; }
+
+   // Appends the given event; returns 'true' in case the buffer has just become half full.
+   bool push( Event const& event ) noexcept
+   {
+      uint64_t const head( head_.load( std::memory_order_relaxed ) );
+      uint64_t const size( head - tail_.load( std::memory_order_acquire ) );
+      if( size == capacity ) {
+         dropped_.store( dropped_.load( std::memory_order_relaxed ) + 1UL, std::memory_order_relaxed );
+         return false;
+      }
+      events_[head & ( capacity - 1UL )] = event;
+      head_.store( head + 1UL, std::memory_order_release );
+      return size + 1UL == capacity / 2UL;
+   }
+
+   template< typename Consumer >
+   void drain( Consumer&& consumer )
+   {
+      uint64_t tail( tail_.load( std::memory_order_relaxed ) );
+      uint64_t const head( head_.load( std::memory_order_acquire ) );
+      for( ; tail != head; ++tail ) {
+         consumer( events_[tail & ( capacity - 1UL )] );
+      }
+      tail_.store( tail, std::memory_order_release );
+   }
+
+   uint64_t dropped() const noexcept { return dropped_.load( std::memory_order_relaxed ); }
+
+   // Marks the buffer as orphaned (i.e. its thread has terminated); it is released after the
+   // next drain.
+   void orphan() noexcept { orphaned_.store( true, std::memory_order_release ); }
+   bool orphaned() const noexcept { return orphaned_.load( std::memory_order_acquire ); }
+
+ private:
+   alignas(64) std::atomic<uint64_t> head_{};
+   alignas(64) std::atomic<uint64_t> tail_{};
+   std::atomic<uint64_t> dropped_{};
+   std::atomic<bool> orphaned_{ false };
+   uint32_t const thread_;
+   std::unique_ptr<Event[]> const events_;
+};
+
+
+//---- <Recorder> ---------------------------------------------------------------------------------
+
+// State of the calling thread, which stays accessible during the destruction of thread-local
+// objects (since it is trivially destructible)
+struct LocalThread
+{
+   uint32_t id{};           // Number of the thread (0 in case the thread has never recorded)
+   bool released{ false };  // The buffer of the thread has been released
+};
+
+thread_local LocalThread localThread{};
+
+
+class Recorder
+{
+ public:
+   // Maximum number of recorded events (about 40 bytes each); further events are dropped
+   static constexpr std::size_t maxEvents = 1UL << 22;
+
+   // The recorder is intentionally never destroyed, such that objects with static storage
+   // duration can still record their destruction during program termination.
+   static Recorder& instance()
+   {
+      static Recorder* const recorder( new Recorder{} );
+      return *recorder;
+   }
+
+   void enable( bool enabled )
+   {
+      enabled_.store( enabled, std::memory_order_relaxed );
+      if( enabled ) startDrain();
+   }
+
+   bool enabled() const { return enabled_.load( std::memory_order_relaxed ); }
+
+   // Records the given event in the buffer of the calling thread (without locking). In case the
+   // buffer is getting full, the drain thread is woken up early. After the buffer of the thread
+   // has been released (i.e. during the destruction of thread-local and static objects), the
+   // event is directly added to the recorded events (under the lock).
+   void record( Event::Kind kind, char const* name, char const* scope, void const* object )
+   {
+      if( localThread.released ) {
+         std::lock_guard<std::mutex> const lock( mutex_ );
+         store( Event{ name, scope, object, ticks(), localThread.id, kind } );
+         return;
+      }
+
+      EventBuffer& buffer( localBuffer() );
+      if( buffer.push( Event{ name, scope, object, ticks(), buffer.thread(), kind } ) ) {
+         wakeup_.notify_one();
+      }
+   }
+
+   bool write( std::string const& filename )
+   {
+      std::ofstream file( filename );
+      if( !file ) return false;
+
+      std::lock_guard<std::mutex> const lock( mutex_ );
+      drainAll();
+
+      std::stable_sort( events_.begin(), events_.end(),
+                        []( Event const& lhs, Event const& rhs ){ return lhs.ticks < rhs.ticks; } );
+      double const ticksPerMicrosecond( calibrate() );
+
+      file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+      bool first( true );
+      for( Event const& event : events_ ) {
+         double const timestamp( static_cast<double>( event.ticks - startTicks_ ) / ticksPerMicrosecond );
+         file << ( first ? "\n" : ",\n" ) << format( event, timestamp );
+         first = false;
+      }
+      file << "\n]}\n";
+
+      uint64_t dropped( dropped_ );
+      for( auto const& buffer : buffers_ ) {
+         dropped += buffer->dropped();
+      }
+      if( dropped > 0UL ) {
+         std::fprintf( stderr, "Warning: %llu trace events were dropped (ring buffer overflow or more "
+                               "than %llu events)\n", static_cast<unsigned long long>( dropped ),
+                       static_cast<unsigned long long>( maxEvents ) );
+      }
+
+      return static_cast<bool>( file );
+   }
+
+ private:
+   using Clock = std::chrono::steady_clock;
+
+   Recorder()
+   {
+      if( char const* const filename = std::getenv( "BENCHMARK_TRACE" ) ) {
+         filename_ = filename;
+         enable( true );
+         std::atexit( []{ instance().writeAtExit(); } );
+      }
+   }
+
+   void writeAtExit()
+   {
+      stopDrain();
+      if( !write( filename_ ) ) {
+         std::fprintf( stderr, "Error: Unable to write trace file '%s'\n", filename_.c_str() );
+      }
+   }
+
+   // Returns the buffer of the calling thread, which is registered on first use and orphaned when
+   // the thread terminates. Must not be called after the buffer has been released.
+   EventBuffer& localBuffer()
+   {
+      struct Owner
+      {
+         explicit Owner( Recorder& recorder )
+            : buffer{ std::make_shared<EventBuffer>( ++recorder.threads_ ) }
+         {
+            localThread.id = buffer->thread();
+            std::lock_guard<std::mutex> const lock( recorder.mutex_ );
+            recorder.buffers_.push_back( buffer );
+         }
+
+         ~Owner()
+         {
+            localThread.released = true;
+            buffer->orphan();
+         }
+
+         std::shared_ptr<EventBuffer> buffer;
+      };
+
+      thread_local Owner const owner( *this );
+      return *owner.buffer;
+   }
+
+   // Adds the given event to the list of recorded events, unless the limit of events has been
+   // reached (the lock has to be held).
+   void store( Event const& event )
+   {
+      if( events_.size() < maxEvents ) {
+         events_.push_back( event );
+      }
+      else {
+         ++dropped_;
+      }
+   }
+
+   // Moves the events of all buffers to the list of recorded events (the lock has to be held). The
+   // buffer of a terminated thread is released once the thread no longer refers to it.
+   void drainAll()
+   {
+      for( auto it=buffers_.begin(); it!=buffers_.end(); )
+      {
+         EventBuffer& buffer( **it );
+         bool const orphaned( buffer.orphaned() && it->use_count() == 1L );
+         buffer.drain( [this]( Event const& event ){ store( event ); } );
+
+         if( orphaned ) {
+            dropped_ += buffer.dropped();
+            it = buffers_.erase( it );
+         }
+         else {
+            ++it;
+         }
+      }
+   }
+
+   // Starts the background thread that periodically drains all buffers.
+   void startDrain()
+   {
+      std::lock_guard<std::mutex> const lock( mutex_ );
+      if( drainer_.joinable() ) return;
+
+      stop_ = false;
+      drainer_ = std::thread( [this]{
+         std::unique_lock<std::mutex> lock( mutex_ );
+         while( !stop_ ) {
+            drainAll();
+            wakeup_.wait_for( lock, std::chrono::milliseconds( 10 ) );
+         }
+      } );
+   }
+
+   void stopDrain()
+   {
+      {
+         std::lock_guard<std::mutex> const lock( mutex_ );
+         if( !drainer_.joinable() ) return;
+         stop_ = true;
+      }
+      wakeup_.notify_all();
+      drainer_.join();
+   }
+
+   // Returns the number of ticks per microsecond, measured against the steady clock since the
+   // construction of the recorder (at least 20ms, for a sufficient precision).
+   double calibrate() const
+   {
+#if defined(__x86_64__) || defined(__i386__)
+      std::this_thread::sleep_until( startTime_ + std::chrono::milliseconds( 20 ) );
+      uint64_t const elapsedTicks( ticks() - startTicks_ );
+      double const elapsedMicroseconds( std::chrono::duration<double,std::micro>( Clock::now() - startTime_ ).count() );
+      return static_cast<double>( elapsedTicks ) / elapsedMicroseconds;
+#else
+      return 1000.0;
+#endif
+   }
+
+   static std::string quote( char const* text )
+   {
+      std::string result( "\"" );
+      for( char const* c=text; c && *c; ++c ) {
+         if( *c == '"' || *c == '\\' ) result += '\\';
+         result += *c;
+      }
+      return result + "\"";
+   }
+
+   static std::string address( void const* object )
+   {
+      std::ostringstream oss{};
+      oss << "0x" << std::hex << reinterpret_cast<std::uintptr_t>( object );
+      return oss.str();
+   }
+
+   static std::string format( Event const& event, double timestamp )
+   {
+      std::ostringstream oss{};
+      oss << std::fixed << std::setprecision( 3 )
+          << "{\"pid\":1,\"tid\":" << event.thread << ",\"ts\":" << timestamp;
+
+      switch( event.kind )
+      {
+         case Event::ScopeBegin:
+         case Event::ScopeEnd:
+            oss << ",\"ph\":\"" << ( event.kind == Event::ScopeBegin ? 'B' : 'E' )
+                << "\",\"cat\":\"scope\",\"name\":" << quote( event.name ) << "}";
+            return oss.str();
+
+         default:
+            break;
+      }
+
+      std::string const object( address( event.object ) );
+      std::string const args( ",\"args\":{\"object\":\"" + object + "\",\"scope\":" +
+                              quote( event.scope ) + "}" );
+
+      // Instant event for the special member function call itself ...
+      oss << ",\"ph\":\"i\",\"s\":\"t\",\"cat\":\"special_member\",\"name\":" << quote( event.name )
+          << args << "}";
+
+      // ... plus the begin/end of the async 'lifetime' slice of the object
+      if( event.kind == Event::Construct || event.kind == Event::Destroy ) {
+         oss << ",\n{\"pid\":1,\"tid\":" << event.thread << ",\"ts\":" << timestamp
+             << ",\"ph\":\"" << ( event.kind == Event::Construct ? 'b' : 'e' )
+             << "\",\"cat\":\"lifetime\",\"name\":\"object " << object << "\",\"id\":\"" << object
+             << "\"" << args << "}";
+      }
+
+      return oss.str();
+   }
+
+   std::atomic<bool> enabled_{ false };
+   std::string filename_{};
+   Clock::time_point const startTime_{ Clock::now() };
+   uint64_t const startTicks_{ ticks() };
+   std::atomic<uint32_t> threads_{};
+   std::mutex mutex_{};                                 // Protects all members below
+   std::vector< std::shared_ptr<EventBuffer> > buffers_{};
+   std::vector<Event> events_{};
+   uint64_t dropped_{};
+   std::thread drainer_{};
+   std::condition_variable wakeup_{};
+   bool stop_{ false };
+};
+
+thread_local char const* currentScope{ nullptr };
+std::atomic<bool> echoing{ true };
+
+void record( Event::Kind kind, char const* name, void const* object )
+{
+   if( kind < Event::ScopeBegin && echoing.load( std::memory_order_relaxed ) ) {
+      std::puts( name );
+   }
+
+   Recorder& recorder( Recorder::instance() );
+   if( recorder.enabled() ) {
+      recorder.record( kind, name, currentScope, object );
+   }
+}
+
+} // namespace
+
+
+void enable( bool enabled )
+{
+   Recorder::instance().enable( enabled );
+}
+
+bool enabled()
+{
+   return Recorder::instance().enabled();
+}
+
+void echo( bool enabled )
+{
+   echoing.store( enabled, std::memory_order_relaxed );
+}
+
+void construct( void const* object, char const* function )
+{
+   record( Event::Construct, function, object );
+}
+
+void assign( void const* object, char const* function )
+{
+   record( Event::Assign, function, object );
+}
+
+void destroy( void const* object, char const* function )
+{
+   record( Event::Destroy, function, object );
+}
+
+char const* call( void const* object, char const* function )
+{
+   std::string_view const name( function );
+   Event::Kind const kind( name.starts_with( '~' ) ? Event::Destroy
+                         : name.find( "operator=" ) != std::string_view::npos ? Event::Assign
+                         : Event::Construct );
+
+   Recorder& recorder( Recorder::instance() );
+   if( recorder.enabled() ) {
+      recorder.record( kind, function, currentScope, object );
+   }
+   return function;
+}
+
+bool write( std::string const& filename )
+{
+   return Recorder::instance().write( filename );
+}
+
+
+//---- <Scope> ------------------------------------------------------------------------------------
+
+Scope::Scope( char const* name )
+   : previous_{ currentScope }
+{
+   currentScope = name;
+   record( Event::ScopeBegin, name, nullptr );
+}
+
+Scope::~Scope()
+{
+   record( Event::ScopeEnd, currentScope, nullptr );
+   currentScope = previous_;
+}
+
+} // namespace trace
+
+} // namespace benchmark
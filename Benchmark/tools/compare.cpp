@@ -0,0 +1,125 @@
+/**************************************************************************************************
+*
+* \file compare.cpp
+* \brief C++ Training - Statistical comparison of two benchmark result files
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* Usage: benchmark_compare [--alpha=<p>] [--min-change=<percent>] [--fail-on-regression]
+*                          <baseline.json> <contender.json>
+*
+* Loads two JSON files written via '--benchmark_out=<file>' and compares the per-repetition
+* samples of all benchmarks contained in both files by means of a two-sided Mann-Whitney U test.
+* A change is flagged as significant if the p-value is below the given alpha (default: 0.05) and
+* the relative change of the median exceeds the given minimum change (default: 0%).
+*
+**************************************************************************************************/
+
+#include "json.h"
+#include "statistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+using benchmark::internal::formatTime;
+using benchmark::internal::loadSamples;
+
+
+int main( int argc, char** argv )
+{
+   double alpha( 0.05 );
+   double minChange( 0.0 );
+   bool failOnRegression( false );
+   std::vector<std::string> files{};
+
+   for( int i=1; i<argc; ++i ) {
+      if( std::strncmp( argv[i], "--alpha=", 8 ) == 0 ) {
+         alpha = std::atof( argv[i] + 8 );
+      }
+      else if( std::strncmp( argv[i], "--min-change=", 13 ) == 0 ) {
+         minChange = std::atof( argv[i] + 13 );
+      }
+      else if( std::strcmp( argv[i], "--fail-on-regression" ) == 0 ) {
+         failOnRegression = true;
+      }
+      else {
+         files.push_back( argv[i] );
+      }
+   }
+
+   if( files.size() != 2UL ) {
+      std::cerr << "Usage: " << argv[0] << " [--alpha=<p>] [--min-change=<percent>] [--fail-on-regression]"
+                << " <baseline.json> <contender.json>\n";
+      return EXIT_FAILURE;
+   }
+
+   try
+   {
+      auto const baseline ( loadSamples( files[0] ) );
+      auto const contender( loadSamples( files[1] ) );
+
+      std::cout << std::left << std::setw( 40 ) << "Benchmark"
+                << std::right << std::setw( 14 ) << "Baseline"
+                << std::setw( 14 ) << "Contender"
+                << std::setw( 10 ) << "Change"
+                << std::setw( 10 ) << "p-value"
+                << "  Result\n"
+                << std::string( 96, '-' ) << "\n";
+
+      std::size_t regressions{};
+
+      for( auto const& [name,before] : baseline )
+      {
+         auto const pos( std::find_if( begin(contender), end(contender),
+                                       [&]( auto const& run ){ return run.first == name; } ) );
+         if( pos == end(contender) ) continue;
+
+         std::vector<double> const& after( pos->second );
+         double const oldMedian( benchmark::internal::median( before ) );
+         double const newMedian( benchmark::internal::median( after ) );
+         double const change( oldMedian > 0.0 ? ( newMedian - oldMedian ) / oldMedian * 100.0 : 0.0 );
+         auto const test( benchmark::internal::mannWhitneyU( before, after ) );
+
+         bool const significant( test.pvalue < alpha && std::abs( change ) >= minChange );
+         char const* verdict( !significant ? "~" : ( change > 0.0 ? "SLOWER" : "FASTER" ) );
+         if( significant && change > 0.0 ) ++regressions;
+
+         std::cout << std::left << std::setw( 40 ) << name
+                   << std::right << std::setw( 14 ) << formatTime( oldMedian )
+                   << std::setw( 14 ) << formatTime( newMedian )
+                   << std::setw( 9 ) << std::fixed << std::setprecision( 1 ) << std::showpos << change << "%"
+                   << std::noshowpos << std::setw( 10 ) << std::setprecision( 4 ) << test.pvalue
+                   << "  " << verdict;
+         if( before.size() < 5UL || after.size() < 5UL ) {
+            std::cout << " (few samples)";
+         }
+         std::cout << "\n";
+      }
+
+      if( failOnRegression && regressions > 0UL ) {
+         std::cerr << regressions << " significant regression(s) detected\n";
+         return EXIT_FAILURE;
+      }
+   }
+   catch( std::exception const& ex )
+   {
+      std::cerr << "Error: " << ex.what() << "\n";
+      return EXIT_FAILURE;
+   }
+
+   return EXIT_SUCCESS;
+}
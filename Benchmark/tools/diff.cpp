@@ -0,0 +1,231 @@
+/**************************************************************************************************
+*
+* \file diff.cpp
+* \brief C++ Training - Differential benchmark of Task/Solution pairs
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* Usage: benchmark_diff [--repetitions=<num>] [--min-time=<seconds>]
+*                       <name> <task>[@<benchmark>] <solution>[@<benchmark>] ...
+*
+* Runs the executables of each Task/Solution pair under the benchmark harness and reports the
+* speedup of the solution, the change in heap allocations per iteration and the change in
+* instructions (per item or per iteration; only available in case hardware performance counters
+* can be used). Each executable is run with '--benchmark_out', i.e. it has to be a benchmark
+* executable (see 'benchmark_program' for ordinary programs). By default, the first benchmark of
+* an executable is compared; a specific benchmark can be selected via '@<benchmark>' (e.g.
+* 'CreateStrings@benchmarkOptimization').
+*
+**************************************************************************************************/
+
+#include "json.h"
+#include "statistics.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#  include <sys/wait.h>
+#endif
+
+
+using benchmark::internal::formatTime;
+using benchmark::internal::Json;
+
+
+//---- Running a single benchmark -----------------------------------------------------------------
+
+struct Result
+{
+   double nanoseconds{};                  // Median time per iteration
+   std::optional<double> allocations{};   // Allocations per iteration
+   std::optional<double> instructions{};  // Instructions per item or iteration
+   std::string instructionsUnit{};        // "instructions/item" or "instructions/iter"
+};
+
+std::string quoteArgument( std::string const& arg )
+{
+   std::string result( "'" );
+   for( char const c : arg ) {
+      if( c == '\'' ) result += "'\\''";
+      else result += c;
+   }
+   return result + "'";
+}
+
+// Runs the given executable ('<executable>[@<benchmark>]') and returns the median of its results;
+// throws a 'std::runtime_error' in case the executable fails.
+Result run( std::string const& operand, int repetitions, std::string const& minTime )
+{
+   std::string const executable( operand.substr( 0UL, operand.find( '@' ) ) );
+   std::string const filter( operand.find( '@' ) != std::string::npos
+                             ? "^" + operand.substr( operand.find( '@' ) + 1UL ) + "$" : "" );
+   static int runs{};
+   std::string const output( ( std::filesystem::temp_directory_path() /
+                               ( "benchmark_diff_" + std::to_string( std::time( nullptr ) ) + "_" +
+                                 std::to_string( ++runs ) + ".json" ) ).string() );
+
+   std::ostringstream command{};
+   command << quoteArgument( executable )
+           << " --benchmark_repetitions=" << repetitions
+           << " --benchmark_min_time=" << minTime
+           << " --benchmark_out=" << quoteArgument( output )
+           << " --benchmark_out_format=json";
+   if( !filter.empty() ) {
+      command << " --benchmark_filter=" << quoteArgument( filter );
+   }
+   command << " >/dev/null 2>&1";
+
+   int status( std::system( command.str().c_str() ) );
+#if defined(WEXITSTATUS)
+   if( status != -1 ) status = WEXITSTATUS( status );
+#endif
+   if( status != 0 ) {
+      std::remove( output.c_str() );
+      throw std::runtime_error( executable + " FAILED (exit code " + std::to_string( status ) + ")" );
+   }
+
+   Json const root( benchmark::internal::loadJson( output ) );
+   std::remove( output.c_str() );
+
+   Json const* benchmarks( root.find( "benchmarks" ) );
+   if( !benchmarks || benchmarks->array.empty() ) {
+      throw std::runtime_error( executable + " did not report any results" );
+   }
+
+   // Collect all repetitions of the first benchmark in the file
+   Json const* runName( benchmarks->array.front().find( "run_name" ) );
+   std::vector<double> times{}, allocations{}, instructions{};
+   std::string instructionsUnit{};
+
+   for( Json const& entry : benchmarks->array )
+   {
+      Json const* name( entry.find( "run_name" ) );
+      Json const* runType( entry.find( "run_type" ) );
+      if( !name || !runName || name->string != runName->string ) continue;
+      if( runType && runType->string != "iteration" ) continue;
+
+      double factor( 1.0 );
+      if( Json const* unit = entry.find( "time_unit" ) ) {
+         if( unit->string == "us" ) factor = 1E3;
+         if( unit->string == "ms" ) factor = 1E6;
+         if( unit->string == "s"  ) factor = 1E9;
+      }
+
+      if( Json const* time = entry.find( "real_time" ) ) times.push_back( time->number * factor );
+      if( Json const* allocs = entry.find( "allocs/iter" ) ) allocations.push_back( allocs->number );
+
+      // The harness reports the instructions per item (if items are processed) or per iteration
+      for( char const* unit : { "instructions/item", "instructions/iter" } ) {
+         if( Json const* instr = entry.find( unit ) ) {
+            instructions.push_back( instr->number );
+            instructionsUnit = unit;
+            break;
+         }
+      }
+   }
+
+   Result result{ benchmark::internal::median( times ), std::nullopt, std::nullopt, instructionsUnit };
+   if( !allocations.empty()  ) result.allocations  = benchmark::internal::median( allocations );
+   if( !instructions.empty() ) result.instructions = benchmark::internal::median( instructions );
+   return result;
+}
+
+
+//---- Formatting ---------------------------------------------------------------------------------
+
+std::string formatDelta( std::optional<double> const& before, std::optional<double> const& after,
+                         bool relative )
+{
+   if( !before || !after ) return "n/a";
+
+   std::ostringstream oss{};
+   oss << std::fixed << std::showpos;
+   if( relative ) {
+      if( *before <= 0.0 ) return "n/a";
+      oss << std::setprecision( 1 ) << ( *after - *before ) / *before * 100.0 << "%";
+   }
+   else {
+      oss << std::setprecision( 2 ) << ( *after - *before );
+   }
+   return oss.str();
+}
+
+
+int main( int argc, char** argv )
+{
+   int repetitions( 5 );
+   std::string minTime( "0.1" );
+   std::vector<std::string> operands{};
+
+   for( int i=1; i<argc; ++i ) {
+      if( std::strncmp( argv[i], "--repetitions=", 14 ) == 0 ) {
+         repetitions = std::max( 1, std::atoi( argv[i] + 14 ) );
+      }
+      else if( std::strncmp( argv[i], "--min-time=", 11 ) == 0 ) {
+         minTime = argv[i] + 11;
+      }
+      else {
+         operands.push_back( argv[i] );
+      }
+   }
+
+   if( operands.empty() || operands.size() % 3UL != 0UL ) {
+      std::cerr << "Usage: " << argv[0] << " [--repetitions=<num>] [--min-time=<seconds>]"
+                << " <name> <task>[@<benchmark>] <solution>[@<benchmark>] ...\n";
+      return EXIT_FAILURE;
+   }
+
+   std::cout << std::left << std::setw( 24 ) << "Program"
+             << std::right << std::setw( 14 ) << "Task"
+             << std::setw( 14 ) << "Solution"
+             << std::setw( 10 ) << "Speedup"
+             << std::setw( 14 ) << "Allocs/iter"
+             << std::setw( 14 ) << "Instructions" << "\n"
+             << std::string( 90, '-' ) << "\n";
+
+   int failures{};
+
+   for( std::size_t i=0UL; i<operands.size(); i+=3UL )
+   {
+      std::cout << std::left << std::setw( 24 ) << operands[i] << std::right << std::flush;
+
+      try {
+         Result const task    ( run( operands[i+1UL], repetitions, minTime ) );
+         Result const solution( run( operands[i+2UL], repetitions, minTime ) );
+
+         std::ostringstream speedup{};
+         speedup << std::fixed << std::setprecision( 2 )
+                 << ( solution.nanoseconds > 0.0 ? task.nanoseconds / solution.nanoseconds : 0.0 ) << "x";
+
+         std::cout << std::setw( 14 ) << formatTime( task.nanoseconds )
+                   << std::setw( 14 ) << formatTime( solution.nanoseconds )
+                   << std::setw( 10 ) << speedup.str()
+                   << std::setw( 14 ) << formatDelta( task.allocations, solution.allocations, false )
+                   << std::setw( 14 ) << ( task.instructionsUnit == solution.instructionsUnit
+                                           ? formatDelta( task.instructions, solution.instructions, true )
+                                           : std::string( "n/a" ) )
+                   << "\n";
+      }
+      catch( std::exception const& ex ) {
+         std::cout << "  " << ex.what() << "\n";
+         ++failures;
+      }
+   }
+
+   return failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
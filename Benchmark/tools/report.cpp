@@ -0,0 +1,142 @@
+/**************************************************************************************************
+*
+* \file report.cpp
+* \brief C++ Training - Comparison of the benchmark results of several build variants
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* Usage: benchmark_report [--title=<title>] <variant>=<results.json> ...
+*
+* Loads the JSON files written via '--benchmark_out=<file>' by the different build variants of
+* the same benchmark executable (e.g. '-O2', '-O3 -march=native', LTO, PGO) and prints a table of
+* the median time of every benchmark per variant. The speedup is reported relative to the first
+* variant.
+*
+**************************************************************************************************/
+
+#include "json.h"
+#include "statistics.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+using benchmark::internal::formatTime;
+using benchmark::internal::loadSamples;
+
+
+struct Variant
+{
+   std::string label{};
+   std::vector< std::pair<std::string,double> > medians{};  // Median time per benchmark (in ns)
+};
+
+// Returns the median time of the given benchmark, or a negative value if it has not been run.
+double find( Variant const& variant, std::string const& name )
+{
+   auto const pos( std::find_if( begin(variant.medians), end(variant.medians),
+                                 [&]( auto const& run ){ return run.first == name; } ) );
+   return pos != end(variant.medians) ? pos->second : -1.0;
+}
+
+
+int main( int argc, char** argv )
+{
+   std::string title{};
+   std::vector<Variant> variants{};
+
+   try
+   {
+      for( int i=1; i<argc; ++i ) {
+         if( std::strncmp( argv[i], "--title=", 8 ) == 0 ) {
+            title = argv[i] + 8;
+            continue;
+         }
+
+         std::string const arg( argv[i] );
+         std::size_t const separator( arg.find( '=' ) );
+         if( separator == std::string::npos ) {
+            variants.clear();
+            break;
+         }
+
+         Variant variant{ arg.substr( 0UL, separator ), {} };
+         for( auto const& [name,samples] : loadSamples( arg.substr( separator+1UL ) ) ) {
+            variant.medians.emplace_back( name, benchmark::internal::median( samples ) );
+         }
+         variants.push_back( std::move(variant) );
+      }
+
+      if( variants.empty() ) {
+         std::cerr << "Usage: " << argv[0] << " [--title=<title>] <variant>=<results.json> ...\n";
+         return EXIT_FAILURE;
+      }
+
+      // The rows comprise all benchmarks of all variants in the order of their first appearance
+      std::vector<std::string> names{};
+      std::size_t nameWidth( 9UL );
+      for( auto const& variant : variants ) {
+         for( auto const& run : variant.medians ) {
+            if( std::find( begin(names), end(names), run.first ) == end(names) ) {
+               names.push_back( run.first );
+               nameWidth = std::max( nameWidth, run.first.size() );
+            }
+         }
+      }
+
+      constexpr int columnWidth( 22 );
+      std::size_t const width( nameWidth + 2UL + variants.size() * columnWidth );
+
+      if( !title.empty() ) {
+         std::cout << "\n" << title << "\n";
+      }
+      std::cout << std::string( width, '-' ) << "\n"
+                << std::left << std::setw( static_cast<int>( nameWidth + 2UL ) ) << "Benchmark" << std::right;
+      for( auto const& variant : variants ) {
+         std::cout << std::setw( columnWidth ) << variant.label;
+      }
+      std::cout << "\n" << std::string( width, '-' ) << "\n";
+
+      for( std::string const& name : names )
+      {
+         std::cout << std::left << std::setw( static_cast<int>( nameWidth + 2UL ) ) << name << std::right;
+
+         double const reference( find( variants.front(), name ) );
+         for( auto const& variant : variants )
+         {
+            double const time( find( variant, name ) );
+            std::ostringstream cell{};
+            if( time < 0.0 ) {
+               cell << "-";
+            }
+            else if( &variant == &variants.front() || reference <= 0.0 || time <= 0.0 ) {
+               cell << formatTime( time );
+            }
+            else {
+               cell << formatTime( time ) << " (" << std::fixed << std::setprecision( 2 )
+                    << reference / time << "x)";
+            }
+            std::cout << std::setw( columnWidth ) << cell.str();
+         }
+         std::cout << "\n";
+      }
+   }
+   catch( std::exception const& ex )
+   {
+      std::cerr << "Error: " << ex.what() << "\n";
+      return EXIT_FAILURE;
+   }
+
+   return EXIT_SUCCESS;
+}
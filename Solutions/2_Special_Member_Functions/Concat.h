@@ -0,0 +1,179 @@
+/**************************************************************************************************
+*
+* \file Concat.h
+* \brief C++ Training - Lazy concatenation of strings via expression templates
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* 'concat( a, b, ... )' does not concatenate anything, but returns a lightweight expression object
+* referring to its operands (strings, string views, string literals, characters, or further
+* concatenations). The result is materialized exactly once, with the total length computed up
+* front: either into a new 'std::string' (via the conversion operator), appended to an existing
+* string ('appendTo()'), or written into a preallocated buffer ('write()'). In contrast to a chain
+* of 'operator+' calls, there is no temporary string and no reallocation:
+*
+*    std::string const s( "A long string with 32 characters" );
+*    std::string const t = concat( s, s, "..." );  // A single allocation
+*
+* Since the expression only refers to its operands, it must not outlive them (i.e. it is not meant
+* to be stored, but to be materialized within the same full-expression).
+*
+**************************************************************************************************/
+
+#ifndef CONCAT_H
+#define CONCAT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+
+template< typename... Parts >
+class Concatenation;
+
+namespace detail {
+
+template< typename T >
+struct IsConcatenation : std::false_type {};
+
+template< typename... Parts >
+struct IsConcatenation< Concatenation<Parts...> > : std::true_type {};
+
+// Operands are stored as 'std::string_view', characters and nested concatenations by value
+template< typename T >
+using Operand = std::conditional_t< IsConcatenation< std::remove_cvref_t<T> >::value ||
+                                    std::is_same_v< std::remove_cvref_t<T>, char >
+                                  , std::remove_cvref_t<T>
+                                  , std::string_view >;
+
+inline std::size_t length( std::string_view s ) noexcept { return s.size(); }
+inline std::size_t length( char ) noexcept { return 1UL; }
+
+template< typename... Parts >
+std::size_t length( Concatenation<Parts...> const& c ) noexcept { return c.size(); }
+
+inline char* copy( char* out, std::string_view s ) noexcept
+{
+   if( !s.empty() ) std::memcpy( out, s.data(), s.size() );
+   return out + s.size();
+}
+
+inline char* copy( char* out, char c ) noexcept
+{
+   *out = c;
+   return out + 1;
+}
+
+template< typename... Parts >
+char* copy( char* out, Concatenation<Parts...> const& c ) noexcept { return c.write( out ); }
+
+} // namespace detail
+
+
+//---- <Concatenation> ----------------------------------------------------------------------------
+
+template< typename... Parts >
+class Concatenation
+{
+ public:
+   explicit Concatenation( Parts... parts ) noexcept
+      : parts_{ parts... }
+   {}
+
+   // Returns the total length of the concatenation.
+   std::size_t size() const noexcept
+   {
+      return std::apply( []( auto const&... parts ){
+         return ( std::size_t{} + ... + detail::length( parts ) );
+      }, parts_ );
+   }
+
+   // Writes the concatenation into the given buffer, which must provide at least 'size()'
+   // characters; returns the end of the written characters.
+   char* write( char* out ) const noexcept
+   {
+      std::apply( [&out]( auto const&... parts ){
+         ( ( out = detail::copy( out, parts ) ), ... );
+      }, parts_ );
+      return out;
+   }
+
+   // Appends the concatenation to the given string (with at most one reallocation). The operands
+   // may refer to the string itself (e.g. 's += concat( s, s )').
+   void appendTo( std::string& destination ) const
+   {
+      std::size_t const offset( destination.size() );
+      std::size_t const length( size() );
+
+      if( offset + length > destination.capacity() ) {
+         // The old buffer is kept alive until the concatenation has been written
+         std::string result{};
+         result.reserve( std::max( offset + length, 2UL*destination.capacity() ) );
+         result.append( destination );
+         writeInto( result, offset, length );
+         destination.swap( result );
+      }
+      else {
+         writeInto( destination, offset, length );
+      }
+   }
+
+   std::string str() const
+   {
+      std::string result{};
+      result.reserve( size() );
+      writeInto( result, 0UL, size() );
+      return result;
+   }
+
+   operator std::string() const { return str(); }
+
+ private:
+   // Resizes the given string (within its capacity) and writes the concatenation at the given
+   // offset, without initializing the characters beforehand (if supported).
+   void writeInto( std::string& destination, std::size_t offset, std::size_t length ) const
+   {
+#if defined(__cpp_lib_string_resize_and_overwrite)
+      destination.resize_and_overwrite( offset + length, [&]( char* data, std::size_t n ) {
+         write( data + offset );
+         return n;
+      } );
+#else
+      destination.resize( offset + length );
+      write( destination.data() + offset );
+#endif
+   }
+
+   std::tuple<Parts...> parts_;
+};
+
+
+//---- concat() -----------------------------------------------------------------------------------
+
+template< typename... Args >
+   requires ( sizeof...(Args) > 0UL ) &&
+            ( ( std::is_convertible_v< Args const&, std::string_view > ||
+                std::is_same_v< std::remove_cvref_t<Args>, char > ||
+                detail::IsConcatenation< std::remove_cvref_t<Args> >::value ) && ... )
+auto concat( Args const&... args ) noexcept
+{
+   return Concatenation< detail::Operand<Args>... >( detail::Operand<Args>( args )... );
+}
+
+// Appends the given concatenation to the given string, e.g. 's += concat( a, b );'.
+template< typename... Parts >
+std::string& operator+=( std::string& destination, Concatenation<Parts...> const& concatenation )
+{
+   concatenation.appendTo( destination );
+   return destination;
+}
+
+#endif
@@ -15,15 +15,64 @@
 *
 **************************************************************************************************/
 
+#include <benchmark/benchmark.h>
+#include "Concat.h"
+#include "StringPool.h"
+#include "StringTable.h"
+#include <algorithm>
 #include <array>
-#include <chrono>
 #include <cstdlib>
-#include <iostream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
 #include <vector>
 
 
-std::array<std::string,3UL> createStrings()
+//---- Benchmark configuration --------------------------------------------------------------------
+
+constexpr size_t N( 100000UL );
+
+
+//---- Baseline Benchmark -------------------------------------------------------------------------
+
+std::vector<std::string> createStrings_1()
+{
+   std::vector<std::string> strings{};
+   strings.reserve( 3 );
+
+   std::string s( "A long string with 32 characters" );
+
+   strings.push_back( s );
+   strings.push_back( s + s );
+   strings.push_back( s );
+
+   return strings;
+}
+
+static void benchmarkBaseline( benchmark::State& state )
+{
+   for( auto _ : state )
+   {
+      std::vector<std::string> strings{};
+
+      for( size_t i=0UL; i<N; ++i ) {
+         std::vector<std::string> tmp{};
+         tmp = createStrings_1();
+         strings.push_back( tmp[0] );
+         strings.push_back( tmp[1] );
+         strings.push_back( tmp[2] );
+      }
+   }
+
+   state.SetItemsProcessed( 3UL * N * state.iterations() );
+}
+BENCHMARK(benchmarkBaseline);
+
+
+//---- Optimized Benchmark ------------------------------------------------------------------------
+
+std::array<std::string,3UL> createStrings_2()
 {
    std::string s( "A long string with 32 characters" );
 
@@ -32,29 +81,203 @@ std::array<std::string,3UL> createStrings()
    return strings;
 }
 
+static void benchmarkOptimization( benchmark::State& state )
+{
+   for( auto _ : state )
+   {
+      std::vector<std::string> strings{};
 
-int main()
+      for( size_t i=0UL; i<N; ++i ) {
+         auto tmp{ createStrings_2() };
+         strings.push_back( std::move( tmp[0] ) );
+         strings.push_back( std::move( tmp[1] ) );
+         strings.push_back( std::move( tmp[2] ) );
+      }
+   }
+
+   state.SetItemsProcessed( 3UL * N * state.iterations() );
+}
+BENCHMARK(benchmarkOptimization);
+
+
+//---- Concat Benchmark ---------------------------------------------------------------------------
+
+// Same as 'createStrings_2()', but creates the concatenated string via 'concat()', i.e. with a
+// single allocation of the final size instead of a copy of 's' that is grown by 'operator+'
+std::array<std::string,3UL> createStringsConcat()
 {
-   const size_t N( 100000UL );
+   std::string s( "A long string with 32 characters" );
 
-   std::vector<std::string> strings{};
+   std::array<std::string,3UL> strings{ s, concat( s, s ), s };
 
-   std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
-   start = std::chrono::high_resolution_clock::now();
+   return strings;
+}
 
-   for( size_t i=0UL; i<N; ++i ) {
-      auto tmp{ createStrings() };
-      strings.push_back( std::move( tmp[0] ) );
-      strings.push_back( std::move( tmp[1] ) );
-      strings.push_back( std::move( tmp[2] ) );
+static void benchmarkConcat( benchmark::State& state )
+{
+   for( auto _ : state )
+   {
+      std::vector<std::string> strings{};
+
+      for( size_t i=0UL; i<N; ++i ) {
+         auto tmp{ createStringsConcat() };
+         strings.push_back( std::move( tmp[0] ) );
+         strings.push_back( std::move( tmp[1] ) );
+         strings.push_back( std::move( tmp[2] ) );
+      }
    }
 
-   end = std::chrono::high_resolution_clock::now();
-   const std::chrono::duration<double> elapsedTime( end - start );
-   const double seconds( elapsedTime.count() );
+   state.SetItemsProcessed( 3UL * N * state.iterations() );
+}
+BENCHMARK(benchmarkConcat);
+
+
+//---- StringTable Benchmark ----------------------------------------------------------------------
+
+// Same as 'benchmarkOptimization()', but collects the strings in a 'StringTable', which stores all
+// characters contiguously instead of allocating a separate buffer for every string
+static void benchmarkStringTable( benchmark::State& state )
+{
+   for( auto _ : state )
+   {
+      StringTable strings{};
 
-   std::cout << " Runtime: " << seconds << "s\n\n";
+      for( size_t i=0UL; i<N; ++i ) {
+         auto tmp{ createStrings_2() };
+         strings.push_back( std::move( tmp[0] ) );
+         strings.push_back( std::move( tmp[1] ) );
+         strings.push_back( std::move( tmp[2] ) );
+      }
+   }
 
-   return EXIT_SUCCESS;
+   state.SetItemsProcessed( 3UL * N * state.iterations() );
 }
+BENCHMARK(benchmarkStringTable);
 
+// Creates the strings directly in the given 'StringTable', i.e. without any temporary string
+void createStringsStringTableDirect( StringTable& strings )
+{
+   std::string_view const s( "A long string with 32 characters" );
+
+   strings.push_back( s );
+   strings.emplace_back( s, s );
+   strings.push_back( s );
+}
+
+static void benchmarkStringTableDirect( benchmark::State& state )
+{
+   for( auto _ : state )
+   {
+      StringTable strings{};
+
+      for( size_t i=0UL; i<N; ++i ) {
+         createStringsStringTableDirect( strings );
+      }
+   }
+
+   state.SetItemsProcessed( 3UL * N * state.iterations() );
+}
+BENCHMARK(benchmarkStringTableDirect);
+
+
+//---- StringPool Benchmark -----------------------------------------------------------------------
+
+// Same as 'benchmarkOptimization()', but interns the strings in a 'StringPool'. Since the content
+// repeats, the pool stores each distinct string once and the vector only stores handles
+static void benchmarkStringPool( benchmark::State& state )
+{
+   for( auto _ : state )
+   {
+      StringPool pool{};
+      std::vector<InternedString> strings{};
+
+      for( size_t i=0UL; i<N; ++i ) {
+         auto tmp{ createStrings_2() };
+         strings.push_back( pool.intern( tmp[0] ) );
+         strings.push_back( pool.intern( tmp[1] ) );
+         strings.push_back( pool.intern( tmp[2] ) );
+      }
+
+      state.counters["distinct"] = static_cast<double>( pool.size() );
+   }
+
+   state.SetItemsProcessed( 3UL * N * state.iterations() );
+}
+BENCHMARK(benchmarkStringPool);
+
+// Interns the strings directly, i.e. the concatenation is written into a reused buffer instead of
+// a new string
+void createStringsStringPoolDirect( StringPool& pool, std::vector<InternedString>& strings, std::string& buffer )
+{
+   std::string_view const s( "A long string with 32 characters" );
+
+   buffer.clear();
+   buffer += concat( s, s );
+
+   strings.push_back( pool.intern( s ) );
+   strings.push_back( pool.intern( buffer ) );
+   strings.push_back( pool.intern( s ) );
+}
+
+static void benchmarkStringPoolDirect( benchmark::State& state )
+{
+   std::string buffer{};
+
+   for( auto _ : state )
+   {
+      StringPool pool{};
+      std::vector<InternedString> strings{};
+
+      for( size_t i=0UL; i<N; ++i ) {
+         createStringsStringPoolDirect( pool, strings, buffer );
+      }
+   }
+
+   state.SetItemsProcessed( 3UL * N * state.iterations() );
+}
+BENCHMARK(benchmarkStringPoolDirect);
+
+// Same as 'benchmarkStringPool()', but all threads intern into a single shared pool (i.e. mostly
+// concurrent lookups of existing strings under a shared lock)
+static void benchmarkStringPoolThreaded( benchmark::State& state )
+{
+   static StringPool pool{};
+
+   for( auto _ : state )
+   {
+      std::vector<InternedString> strings{};
+
+      for( size_t i=0UL; i<N; ++i ) {
+         auto tmp{ createStrings_2() };
+         strings.push_back( pool.intern( tmp[0] ) );
+         strings.push_back( pool.intern( tmp[1] ) );
+         strings.push_back( pool.intern( tmp[2] ) );
+      }
+   }
+
+   state.SetItemsProcessed( 3UL * N * state.iterations() );
+}
+BENCHMARK(benchmarkStringPoolThreaded)
+   ->ThreadRange( 1, static_cast<int>( std::max( std::thread::hardware_concurrency(), 1U ) ) )
+   ->ExplicitOnly();
+
+
+//---- Latency of the push_back() operations ------------------------------------------------------
+
+static void benchmarkOptimizationLatency( benchmark::State& state )
+{
+   for( auto _ : state )
+   {
+      std::vector<std::string> strings{};
+
+      for( size_t i=0UL; i<N; ++i ) {
+         auto tmp{ createStrings_2() };
+         state.MeasureLatency( [&]{ strings.push_back( std::move( tmp[0] ) ); } );
+         state.MeasureLatency( [&]{ strings.push_back( std::move( tmp[1] ) ); } );
+         state.MeasureLatency( [&]{ strings.push_back( std::move( tmp[2] ) ); } );
+      }
+   }
+
+   state.SetItemsProcessed( 3UL * N * state.iterations() );
+}
+BENCHMARK(benchmarkOptimizationLatency)->ExplicitOnly();
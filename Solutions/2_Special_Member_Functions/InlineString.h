@@ -0,0 +1,367 @@
+/**************************************************************************************************
+*
+* \file InlineString.h
+* \brief C++ Training - String with a configurable small string buffer
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* 'InlineString<N>' stores up to 'N' characters (plus the terminating null character) within the
+* object itself and only falls back to the heap for longer strings. In contrast, the small string
+* optimization (SSO) of 'std::string' is limited to 15 characters in libstdc++ and 22 characters
+* in libc++, i.e. the typical 30 to 32 character payloads of the examples (e.g. "A long string of
+* 30 characters") require a heap allocation:
+*
+*    InlineString<32> s( "A long string with 32 characters" );  // No allocation
+*
+* The price is the size of the object ('sizeof(InlineString<32>)' is 56 bytes, compared to 32
+* bytes for 'std::string'), which has to be copied on every move of an inline string. The move
+* operations are 'noexcept'. The interface is the subset of the 'std::string' interface used in
+* the examples.
+*
+**************************************************************************************************/
+
+#ifndef INLINESTRING_H
+#define INLINESTRING_H
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+
+template< std::size_t N >
+class InlineString
+{
+ public:
+   using value_type      = char;
+   using size_type       = std::size_t;
+   using iterator        = char*;
+   using const_iterator  = char const*;
+
+   static constexpr size_type npos = std::string_view::npos;
+
+   //---- Construction and destruction ------------------------------------------------------------
+
+   InlineString() noexcept
+      : data_{ buffer_ }
+   {
+      buffer_[0] = '\0';
+   }
+
+   InlineString( char const* s )
+      : InlineString( std::string_view( s ) )
+   {}
+
+   InlineString( char const* s, size_type count )
+      : InlineString( std::string_view( s, count ) )
+   {}
+
+   explicit InlineString( std::string_view s )
+      : InlineString()
+   {
+      assign( s );
+   }
+
+   InlineString( std::string const& s )
+      : InlineString( std::string_view( s ) )
+   {}
+
+   InlineString( size_type count, char c )
+      : InlineString()
+   {
+      resize( count, c );
+   }
+
+   InlineString( InlineString const& other )
+      : InlineString( other.view() )
+   {}
+
+   InlineString( InlineString&& other ) noexcept
+      : InlineString()
+   {
+      steal( other );
+   }
+
+   ~InlineString()
+   {
+      release();
+   }
+
+   InlineString& operator=( InlineString const& other )
+   {
+      if( this != &other ) assign( other.view() );
+      return *this;
+   }
+
+   InlineString& operator=( InlineString&& other ) noexcept
+   {
+      if( this != &other ) {
+         release();
+         data_ = buffer_;
+         steal( other );
+      }
+      return *this;
+   }
+
+   InlineString& operator=( std::string_view s )
+   {
+      assign( s );
+      return *this;
+   }
+
+   InlineString& operator=( char const* s )
+   {
+      assign( std::string_view( s ) );
+      return *this;
+   }
+
+   //---- Element access --------------------------------------------------------------------------
+
+   char&       operator[]( size_type index )       noexcept { return data_[index]; }
+   char const& operator[]( size_type index ) const noexcept { return data_[index]; }
+
+   char const& at( size_type index ) const
+   {
+      if( index >= size_ ) {
+         throw std::out_of_range( "Invalid InlineString access index" );
+      }
+      return data_[index];
+   }
+
+   char*       data()        noexcept { return data_; }
+   char const* data()  const noexcept { return data_; }
+   char const* c_str() const noexcept { return data_; }
+
+   std::string_view view() const noexcept { return std::string_view( data_, size_ ); }
+   std::string str() const { return std::string( data_, size_ ); }
+
+   operator std::string_view() const noexcept { return view(); }
+
+   iterator       begin()        noexcept { return data_; }
+   const_iterator begin()  const noexcept { return data_; }
+   const_iterator cbegin() const noexcept { return data_; }
+   iterator       end()          noexcept { return data_ + size_; }
+   const_iterator end()    const noexcept { return data_ + size_; }
+   const_iterator cend()   const noexcept { return data_ + size_; }
+
+   //---- Capacity --------------------------------------------------------------------------------
+
+   size_type size()     const noexcept { return size_; }
+   size_type length()   const noexcept { return size_; }
+   bool      empty()    const noexcept { return size_ == 0UL; }
+   size_type capacity() const noexcept { return isInline() ? N : capacity_; }
+
+   // Returns whether the characters are stored within the object (i.e. not on the heap).
+   bool isInline() const noexcept { return data_ == buffer_; }
+
+   static constexpr size_type inlineCapacity() noexcept { return N; }
+
+   void reserve( size_type n )
+   {
+      if( n > capacity() ) {
+         reallocate( n );
+      }
+   }
+
+   //---- Modifiers -------------------------------------------------------------------------------
+
+   void clear() noexcept
+   {
+      size_ = 0UL;
+      data_[0] = '\0';
+   }
+
+   InlineString& assign( std::string_view s )
+   {
+      if( s.size() > capacity() ) {
+         InlineString tmp{};  // The given characters may refer to the string itself
+         tmp.reallocate( s.size() );
+         std::memcpy( tmp.data_, s.data(), s.size() );
+         tmp.setSize( s.size() );
+         *this = std::move( tmp );
+      }
+      else {
+         if( !s.empty() ) std::memmove( data_, s.data(), s.size() );
+         setSize( s.size() );
+      }
+      return *this;
+   }
+
+   InlineString& append( std::string_view s )
+   {
+      size_type const newSize( size_ + s.size() );
+      if( newSize > capacity() ) {
+         InlineString tmp{};  // The given characters may refer to the string itself
+         tmp.reallocate( std::max( newSize, 2UL*capacity() ) );
+         std::memcpy( tmp.data_, data_, size_ );
+         std::memcpy( tmp.data_ + size_, s.data(), s.size() );
+         tmp.setSize( newSize );
+         *this = std::move( tmp );
+      }
+      else {
+         if( !s.empty() ) std::memmove( data_ + size_, s.data(), s.size() );
+         setSize( newSize );
+      }
+      return *this;
+   }
+
+   InlineString& operator+=( std::string_view s ) { return append( s ); }
+   InlineString& operator+=( char c ) { push_back( c ); return *this; }
+
+   void push_back( char c )
+   {
+      if( size_ == capacity() ) {
+         reallocate( std::max( size_ + 1UL, 2UL*capacity() ) );
+      }
+      data_[size_] = c;
+      setSize( size_ + 1UL );
+   }
+
+   void pop_back() noexcept
+   {
+      setSize( size_ - 1UL );
+   }
+
+   void resize( size_type count, char c = '\0' )
+   {
+      if( count > size_ ) {
+         reserve( count );
+         std::fill( data_ + size_, data_ + count, c );
+      }
+      setSize( count );
+   }
+
+   void swap( InlineString& other ) noexcept
+   {
+      InlineString tmp( std::move( other ) );
+      other = std::move( *this );
+      *this = std::move( tmp );
+   }
+
+   //---- Operations ------------------------------------------------------------------------------
+
+   size_type find( std::string_view s, size_type pos = 0UL ) const noexcept
+   {
+      return view().find( s, pos );
+   }
+
+   size_type find( char c, size_type pos = 0UL ) const noexcept
+   {
+      return view().find( c, pos );
+   }
+
+   InlineString substr( size_type pos = 0UL, size_type count = npos ) const
+   {
+      return InlineString( view().substr( pos, count ) );
+   }
+
+   friend InlineString operator+( InlineString const& lhs, std::string_view rhs )
+   {
+      InlineString result{};
+      result.reserve( lhs.size() + rhs.size() );
+      result.append( lhs.view() ).append( rhs );
+      return result;
+   }
+
+   friend InlineString operator+( InlineString&& lhs, std::string_view rhs )
+   {
+      lhs.append( rhs );
+      return std::move( lhs );
+   }
+
+   friend bool operator==( InlineString const& lhs, InlineString const& rhs ) noexcept
+   {
+      return lhs.view() == rhs.view();
+   }
+
+   friend bool operator==( InlineString const& lhs, std::string_view rhs ) noexcept
+   {
+      return lhs.view() == rhs;
+   }
+
+   friend bool operator==( InlineString const& lhs, char const* rhs ) noexcept
+   {
+      return lhs.view() == rhs;
+   }
+
+   friend std::strong_ordering operator<=>( InlineString const& lhs, InlineString const& rhs ) noexcept
+   {
+      return lhs.view() <=> rhs.view();
+   }
+
+   friend std::strong_ordering operator<=>( InlineString const& lhs, std::string_view rhs ) noexcept
+   {
+      return lhs.view() <=> rhs;
+   }
+
+   friend std::strong_ordering operator<=>( InlineString const& lhs, char const* rhs ) noexcept
+   {
+      return lhs.view() <=> rhs;
+   }
+
+   friend std::ostream& operator<<( std::ostream& os, InlineString const& s )
+   {
+      return os << s.view();
+   }
+
+ private:
+   void setSize( size_type size ) noexcept
+   {
+      size_ = size;
+      data_[size_] = '\0';
+   }
+
+   // Moves the characters to a heap buffer for the given number of characters.
+   void reallocate( size_type capacity )
+   {
+      char* const data( new char[capacity+1UL] );
+      std::memcpy( data, data_, size_+1UL );
+      release();
+      data_ = data;
+      capacity_ = capacity;
+   }
+
+   void release() noexcept
+   {
+      if( !isInline() ) delete[] data_;
+   }
+
+   // Takes over the characters of the given string and leaves it empty; requires this string to
+   // be empty and inline.
+   void steal( InlineString& other ) noexcept
+   {
+      if( other.isInline() ) {
+         std::memcpy( buffer_, other.buffer_, other.size_+1UL );
+      }
+      else {
+         data_ = other.data_;
+         capacity_ = other.capacity_;
+         other.data_ = other.buffer_;
+      }
+      size_ = other.size_;
+      other.setSize( 0UL );
+   }
+
+   char* data_;         // Refers to either the inline buffer or the heap buffer
+   size_type size_{};
+   union {
+      char buffer_[N+1UL];   // Inline characters (including the terminating null character)
+      size_type capacity_;   // Capacity of the heap buffer
+   };
+};
+
+template< std::size_t N >
+void swap( InlineString<N>& lhs, InlineString<N>& rhs ) noexcept
+{
+   lhs.swap( rhs );
+}
+
+#endif
@@ -0,0 +1,123 @@
+/**************************************************************************************************
+*
+* \file InlineStrings.cpp
+* \brief C++ Training - Strings with a larger small string buffer
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* Repeats the 'emplace_back()' benchmark of 'MoveNoexcept.cpp' (30 character strings) and the
+* 'createStrings()' benchmark of 'CreateStrings.cpp' (32 and 64 character strings) with
+* 'std::string' and with 'InlineString<N>' (see "InlineString.h") as the underlying string type.
+* Compare the runtime, the number of allocations and the peak memory:
+*
+*    InlineStrings --benchmark_repetitions=1
+*
+* Note that 'InlineString<32>' stores the 30 and 32 character strings inline, but still allocates
+* for the concatenation 's + s', whereas 'InlineString<64>' stores all strings inline at the price
+* of a larger vector (and larger objects to move on every reallocation).
+*
+**************************************************************************************************/
+
+#include <benchmark/benchmark.h>
+#include "InlineString.h"
+#include <array>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+//---- <String> -----------------------------------------------------------------------------------
+
+// Same as the 'String' of 'MoveNoexcept.cpp', but with a configurable underlying string type
+template< typename Storage >
+struct String
+{
+ public:
+   String() = default;
+
+   String( const char* s )
+      : s_{ s }
+   {}
+
+   ~String() = default;
+   String( const String& ) = default;
+   String& operator=( const String& ) = default;
+   String( String&& ) noexcept(true) = default;
+   String& operator=( String&& ) noexcept(true) = default;
+
+ private:
+   Storage s_;
+};
+
+
+//---- emplace_back() Benchmark -------------------------------------------------------------------
+
+template< typename Storage >
+static void benchmarkEmplaceBack( benchmark::State& state )
+{
+   constexpr size_t N( 1000000 );
+
+   for( auto _ : state )
+   {
+      std::vector< String<Storage> > v;
+
+      for( size_t i=0UL; i<N; ++i ) {
+         v.emplace_back( "A long string of 30 characters" );
+      }
+
+      benchmark::DoNotOptimize( v );
+
+      // Exclude the destruction of the strings from the measurement
+      state.PauseTiming();
+      v.clear();
+      v.shrink_to_fit();
+      state.ResumeTiming();
+   }
+
+   state.SetItemsProcessed( N * state.iterations() );
+}
+BENCHMARK_TEMPLATE(benchmarkEmplaceBack,std::string);
+BENCHMARK_TEMPLATE(benchmarkEmplaceBack,InlineString<32>);
+BENCHMARK_TEMPLATE(benchmarkEmplaceBack,InlineString<64>);
+
+
+//---- createStrings() Benchmark ------------------------------------------------------------------
+
+template< typename Storage >
+std::array<Storage,3UL> createStrings()
+{
+   Storage s( "A long string with 32 characters" );
+
+   std::array<Storage,3UL> strings{ s, s+s, s };
+
+   return strings;
+}
+
+template< typename Storage >
+static void benchmarkCreateStrings( benchmark::State& state )
+{
+   constexpr size_t N( 100000UL );
+
+   for( auto _ : state )
+   {
+      std::vector<Storage> strings{};
+
+      for( size_t i=0UL; i<N; ++i ) {
+         auto tmp{ createStrings<Storage>() };
+         strings.push_back( std::move( tmp[0] ) );
+         strings.push_back( std::move( tmp[1] ) );
+         strings.push_back( std::move( tmp[2] ) );
+      }
+
+      benchmark::DoNotOptimize( strings );
+   }
+
+   state.SetItemsProcessed( 3UL * N * state.iterations() );
+}
+BENCHMARK_TEMPLATE(benchmarkCreateStrings,std::string);
+BENCHMARK_TEMPLATE(benchmarkCreateStrings,InlineString<32>);
+BENCHMARK_TEMPLATE(benchmarkCreateStrings,InlineString<64>);
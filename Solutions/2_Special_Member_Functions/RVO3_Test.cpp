@@ -0,0 +1,362 @@
+/**************************************************************************************************
+*
+* \file RVO3_Test.cpp
+* \brief C++ Training - Copy elision tests for the RVO examples
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* Runs copies of the twelve examples of 'RVO3.cpp' with a counting 'S' (see <benchmark/traced.h>)
+* and checks the exact number of copy and move operations. Guaranteed copy elision (C++17) applies
+* to all examples returning a prvalue; all other results depend on the named return value
+* optimization (NRVO), which is not guaranteed by the standard. The expected results reflect GCC
+* and Clang. The test is registered via ctest ('ctest -R RVO3') and fails in case a compiler (or
+* an optimization level) loses an elision. Since the Task is an exercise with commented-out
+* examples, the test does not include it; a change of the examples in 'RVO3.cpp' has to be
+* repeated here.
+*
+**************************************************************************************************/
+
+#include <benchmark/traced.h>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+
+
+using S = benchmark::Traced<std::string>;
+
+
+//*************************************************************************************************
+// RVO Example 1: Return of unnamed stack variable
+namespace example1 {
+
+S f()
+{
+   return S{};
+}
+
+void run( bool )
+{
+   S s{ f() };
+}
+
+} // namespace example1
+//*************************************************************************************************
+
+
+//*************************************************************************************************
+// RVO Example 2: Return of named stack variable
+namespace example2 {
+
+S f()
+{
+   S s{ "1" };
+   s = S{ "2" };
+   return s;
+}
+
+void run( bool )
+{
+   S s{ f() };
+}
+
+} // namespace example2
+//*************************************************************************************************
+
+
+//*************************************************************************************************
+// RVO Example 3: Return stack variable by means of move
+namespace example3 {
+
+#if defined(__GNUC__)
+#  pragma GCC diagnostic push
+#  pragma GCC diagnostic ignored "-Wpessimizing-move"
+#endif
+
+S f()
+{
+   S s{};
+   return std::move(s);
+}
+
+#if defined(__GNUC__)
+#  pragma GCC diagnostic pop
+#endif
+
+void run( bool )
+{
+   S s{ f() };
+}
+
+} // namespace example3
+//*************************************************************************************************
+
+
+//*************************************************************************************************
+// RVO Example 4: Return of function argument
+namespace example4 {
+
+S f( S s )
+{
+   return s;
+}
+
+void run( bool )
+{
+   S s1{};
+   S s2{ f( s1 ) };
+}
+
+} // namespace example4
+//*************************************************************************************************
+
+
+//*************************************************************************************************
+// RVO Example 5: Conditional return of function argument
+namespace example5 {
+
+S f( bool b, S s )
+{
+   if( b )
+      s = S{};
+   return s;
+}
+
+void run( bool b )
+{
+   S s1{};
+   S s2{ f( b, s1 ) };
+}
+
+} // namespace example5
+//*************************************************************************************************
+
+
+//*************************************************************************************************
+// RVO Example 6: Conditional return of lvalues
+namespace example6 {
+
+S f( bool b )
+{
+   S s1{};
+   S s2{};
+
+   if( b )
+      return s1;
+   else
+      return s2;
+}
+
+void run( bool b )
+{
+   S s{ f( b ) };
+}
+
+} // namespace example6
+//*************************************************************************************************
+
+
+//*************************************************************************************************
+// RVO Example 7: Conditional return of rvalues (1)
+namespace example7 {
+
+S f( bool b )
+{
+   if( b )
+      return S{};
+   else
+      return S{};
+}
+
+void run( bool b )
+{
+   S s{ f( b ) };
+}
+
+} // namespace example7
+//*************************************************************************************************
+
+
+//*************************************************************************************************
+// RVO Example 8: Conditional return of rvalues (2)
+namespace example8 {
+
+S getS() { return S{ "First option" }; }
+
+S f( bool b )
+{
+   if( b )
+      return getS();
+   return S{ "Second option" };
+}
+
+void run( bool b )
+{
+   S s{ f( b ) };
+}
+
+} // namespace example8
+//*************************************************************************************************
+
+
+//*************************************************************************************************
+// RVO Example 9: Conditional return of lvalue vs. rvalue (1)
+namespace example9 {
+
+S f( bool b )
+{
+   if( b )
+   {
+      S s{};
+      return s;
+   }
+   return S{};
+}
+
+void run( bool b )
+{
+   S s{ f( b ) };
+}
+
+} // namespace example9
+//*************************************************************************************************
+
+
+//*************************************************************************************************
+// RVO Example 10: Conditional return of lvalue vs. rvalue (2)
+namespace example10 {
+
+S f( bool b )
+{
+   S s{};
+   if( b )
+      return s;
+   return S{};
+}
+
+void run( bool b )
+{
+   S s{ f( b ) };
+}
+
+} // namespace example10
+//*************************************************************************************************
+
+
+//*************************************************************************************************
+// RVO Example 11: Return from conditional operator (1)
+namespace example11 {
+
+S f( bool b )
+{
+   S s{};
+   return b ? s : S{};
+}
+
+void run( bool b )
+{
+   S s{ f( b ) };
+}
+
+} // namespace example11
+//*************************************************************************************************
+
+
+//*************************************************************************************************
+// RVO Example 12: Return from conditional operator (2)
+namespace example12 {
+
+S getS() { return S{}; }
+
+S f( bool b )
+{
+   return b ? getS() : S{};
+}
+
+void run( bool b )
+{
+   S s{ f( b ) };
+}
+
+} // namespace example12
+//*************************************************************************************************
+
+
+//---- Test driver --------------------------------------------------------------------------------
+
+struct Expectation
+{
+   char const* name;
+   void (*run)( bool );
+   bool b;
+   int64_t copyConstructions;
+   int64_t moveConstructions;
+   int64_t copyAssignments;
+   int64_t moveAssignments;
+};
+
+// NRVO is applied by Clang but not by GCC in case a named variable is returned from a nested scope
+#if defined(__clang__)
+constexpr int64_t nestedScopeMoves( 0 );
+#else
+constexpr int64_t nestedScopeMoves( 1 );
+#endif
+
+constexpr Expectation expectations[] = {
+   // Name, example, argument 'b', copy constructions, move constructions, copy/move assignments
+   { "Example 1"           , example1::run , false, 0, 0, 0, 0 },  // Guaranteed elision
+   { "Example 2"           , example2::run , false, 0, 0, 0, 1 },  // NRVO (plus the move assignment)
+   { "Example 3"           , example3::run , false, 0, 1, 0, 0 },  // 'std::move()' prevents NRVO
+   { "Example 4"           , example4::run , false, 1, 1, 0, 0 },  // No NRVO for function parameters
+   { "Example 5 (true)"    , example5::run , true , 1, 1, 0, 1 },
+   { "Example 5 (false)"   , example5::run , false, 1, 1, 0, 0 },
+   { "Example 6 (true)"    , example6::run , true , 0, 1, 0, 0 },  // No NRVO for two candidates
+   { "Example 6 (false)"   , example6::run , false, 0, 1, 0, 0 },
+   { "Example 7 (true)"    , example7::run , true , 0, 0, 0, 0 },  // Guaranteed elision
+   { "Example 7 (false)"   , example7::run , false, 0, 0, 0, 0 },
+   { "Example 8 (true)"    , example8::run , true , 0, 0, 0, 0 },  // Guaranteed elision
+   { "Example 8 (false)"   , example8::run , false, 0, 0, 0, 0 },
+   { "Example 9 (true)"    , example9::run , true , 0, nestedScopeMoves, 0, 0 },
+   { "Example 9 (false)"   , example9::run , false, 0, 0, 0, 0 },
+   { "Example 10 (true)"   , example10::run, true , 0, 1, 0, 0 },  // 's' is alive at 'return S{}'
+   { "Example 10 (false)"  , example10::run, false, 0, 0, 0, 0 },
+   { "Example 11 (true)"   , example11::run, true , 1, 0, 0, 0 },  // The result is a copy of 's'
+   { "Example 11 (false)"  , example11::run, false, 0, 0, 0, 0 },
+   { "Example 12 (true)"   , example12::run, true , 0, 0, 0, 0 },  // Guaranteed elision
+   { "Example 12 (false)"  , example12::run, false, 0, 0, 0, 0 },
+};
+
+
+int main()
+{
+   int failures{};
+
+   for( auto const& expected : expectations )
+   {
+      S::reset();
+      expected.run( expected.b );
+      benchmark::TracedCounts const counts( S::counts() );
+
+      bool const passed( counts.copyConstructions == expected.copyConstructions &&
+                         counts.moveConstructions == expected.moveConstructions &&
+                         counts.copyAssignments   == expected.copyAssignments   &&
+                         counts.moveAssignments   == expected.moveAssignments   &&
+                         counts.constructions()   == counts.destructions );
+
+      std::cout << ( passed ? "[ PASSED ] " : "[ FAILED ] " ) << expected.name
+                << ": copies=" << counts.copyConstructions << "+" << counts.copyAssignments
+                << " moves=" << counts.moveConstructions << "+" << counts.moveAssignments;
+      if( !passed ) {
+         std::cout << " (expected copies=" << expected.copyConstructions << "+" << expected.copyAssignments
+                   << " moves=" << expected.moveConstructions << "+" << expected.moveAssignments << ")";
+         ++failures;
+      }
+      std::cout << "\n";
+   }
+
+   return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
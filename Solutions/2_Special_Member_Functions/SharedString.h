@@ -0,0 +1,233 @@
+/**************************************************************************************************
+*
+* \file SharedString.h
+* \brief C++ Training - Immutable, reference-counted string
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* A 'SharedString' is an immutable string, whose characters are stored in a single heap
+* allocation together with a reference count. Since the characters are never modified, all
+* copies share the same allocation, i.e. a copy is an increment of the reference count instead of
+* an allocation and a copy of the characters (as for 'std::string'). The allocation is released
+* by the destruction of the last copy. This pays off for data that is written once and copied or
+* read many times:
+*
+*    SharedString const s( "A long string with 32 characters" );  // One allocation
+*    std::vector<SharedString> strings( 1000, s );                 // No further allocation
+*
+* By default, the reference count is atomic and copies of the same string can be used by several
+* threads concurrently. 'LocalSharedString' uses a plain counter instead, which avoids the cost
+* of the atomic read-modify-write operations, but must only be used within a single thread.
+*
+**************************************************************************************************/
+
+#ifndef SHAREDSTRING_H
+#define SHAREDSTRING_H
+
+#include <atomic>
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+
+template< bool ThreadSafe >
+class BasicSharedString
+{
+ public:
+   using value_type     = char;
+   using size_type      = std::size_t;
+   using const_iterator = char const*;
+
+   // Refers to the empty string (without any allocation).
+   BasicSharedString() noexcept = default;
+
+   BasicSharedString( char const* s )
+      : BasicSharedString( std::string_view( s ) )
+   {}
+
+   BasicSharedString( std::string const& s )
+      : BasicSharedString( std::string_view( s ) )
+   {}
+
+   explicit BasicSharedString( std::string_view s )
+   {
+      if( s.empty() ) return;
+
+      void* const memory( ::operator new( sizeof(Header) + s.size() + 1UL ) );
+      header_ = ::new( memory ) Header{ 1UL, s.size() };
+      std::memcpy( header_->characters(), s.data(), s.size() );
+      header_->characters()[s.size()] = '\0';
+   }
+
+   BasicSharedString( BasicSharedString const& other ) noexcept
+      : header_{ other.header_ }
+   {
+      if( header_ ) header_->acquire();
+   }
+
+   BasicSharedString( BasicSharedString&& other ) noexcept
+      : header_{ std::exchange( other.header_, nullptr ) }
+   {}
+
+   ~BasicSharedString()
+   {
+      release();
+   }
+
+   BasicSharedString& operator=( BasicSharedString const& other ) noexcept
+   {
+      BasicSharedString( other ).swap( *this );
+      return *this;
+   }
+
+   BasicSharedString& operator=( BasicSharedString&& other ) noexcept
+   {
+      BasicSharedString( std::move( other ) ).swap( *this );
+      return *this;
+   }
+
+   char const* data() const noexcept { return header_ ? header_->characters() : ""; }
+   char const* c_str() const noexcept { return data(); }
+
+   size_type size()   const noexcept { return header_ ? header_->size : 0UL; }
+   size_type length() const noexcept { return size(); }
+   bool      empty()  const noexcept { return header_ == nullptr; }
+
+   char operator[]( size_type index ) const noexcept { return data()[index]; }
+
+   const_iterator begin() const noexcept { return data(); }
+   const_iterator end()   const noexcept { return data() + size(); }
+
+   std::string_view view() const noexcept { return std::string_view( data(), size() ); }
+   std::string str() const { return std::string( view() ); }
+
+   operator std::string_view() const noexcept { return view(); }
+
+   // Returns the number of strings sharing the characters (0 for the empty string).
+   size_type use_count() const noexcept { return header_ ? header_->count() : 0UL; }
+
+   void swap( BasicSharedString& other ) noexcept
+   {
+      std::swap( header_, other.header_ );
+   }
+
+   friend bool operator==( BasicSharedString const& lhs, BasicSharedString const& rhs ) noexcept
+   {
+      return lhs.header_ == rhs.header_ || lhs.view() == rhs.view();
+   }
+
+   friend bool operator==( BasicSharedString const& lhs, std::string_view rhs ) noexcept
+   {
+      return lhs.view() == rhs;
+   }
+
+   friend bool operator==( BasicSharedString const& lhs, char const* rhs ) noexcept
+   {
+      return lhs.view() == rhs;
+   }
+
+   friend std::strong_ordering operator<=>( BasicSharedString const& lhs, BasicSharedString const& rhs ) noexcept
+   {
+      return lhs.view() <=> rhs.view();
+   }
+
+   friend std::strong_ordering operator<=>( BasicSharedString const& lhs, std::string_view rhs ) noexcept
+   {
+      return lhs.view() <=> rhs;
+   }
+
+   friend std::strong_ordering operator<=>( BasicSharedString const& lhs, char const* rhs ) noexcept
+   {
+      return lhs.view() <=> rhs;
+   }
+
+   friend std::ostream& operator<<( std::ostream& os, BasicSharedString const& s )
+   {
+      return os << s.view();
+   }
+
+ private:
+   using Counter = std::conditional_t< ThreadSafe, std::atomic<size_type>, size_type >;
+
+   // Header of the allocation, which is directly followed by the characters
+   struct Header
+   {
+      Counter references;
+      size_type size;
+
+      char* characters() noexcept { return reinterpret_cast<char*>( this + 1 ); }
+
+      void acquire() noexcept
+      {
+         if constexpr( ThreadSafe ) {
+            // A new reference can only be created from an existing one, thus no ordering is needed
+            references.fetch_add( 1UL, std::memory_order_relaxed );
+         }
+         else {
+            ++references;
+         }
+      }
+
+      // Returns whether the last reference has been released.
+      bool drop() noexcept
+      {
+         if constexpr( ThreadSafe ) {
+            // All accesses of other threads happen before the deallocation by the last thread
+            return references.fetch_sub( 1UL, std::memory_order_acq_rel ) == 1UL;
+         }
+         else {
+            return --references == 0UL;
+         }
+      }
+
+      size_type count() const noexcept
+      {
+         if constexpr( ThreadSafe ) {
+            return references.load( std::memory_order_relaxed );
+         }
+         else {
+            return references;
+         }
+      }
+   };
+
+   void release() noexcept
+   {
+      if( header_ && header_->drop() ) {
+         header_->~Header();
+         ::operator delete( header_ );
+      }
+   }
+
+   Header* header_{ nullptr };
+};
+
+using SharedString      = BasicSharedString<true>;
+using LocalSharedString = BasicSharedString<false>;
+
+template< bool ThreadSafe >
+void swap( BasicSharedString<ThreadSafe>& lhs, BasicSharedString<ThreadSafe>& rhs ) noexcept
+{
+   lhs.swap( rhs );
+}
+
+template< bool ThreadSafe >
+struct std::hash< BasicSharedString<ThreadSafe> >
+{
+   std::size_t operator()( BasicSharedString<ThreadSafe> const& s ) const noexcept
+   {
+      return std::hash<std::string_view>{}( s.view() );
+   }
+};
+
+#endif
@@ -0,0 +1,134 @@
+/**************************************************************************************************
+*
+* \file SharedStrings.cpp
+* \brief C++ Training - Immutable, reference-counted strings for copy-heavy code
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* Repeats the baseline of 'CreateStrings.cpp', which copies every string into the result vector,
+* and the 'emplace_back()' benchmark of 'MoveNoexcept.cpp' with a potentially throwing move (i.e.
+* the vector copies the elements on every reallocation) with 'std::string', 'SharedString' and
+* 'LocalSharedString' (see "SharedString.h"). Compare the runtime and the number of allocations:
+*
+*    SharedStrings --benchmark_repetitions=1
+*
+* Also compare the cost of the atomic reference count ('SharedString') with the cost of the
+* plain reference count ('LocalSharedString').
+*
+**************************************************************************************************/
+
+#include <benchmark/benchmark.h>
+#include "SharedString.h"
+#include <cstdlib>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+//---- createStrings() Benchmark ------------------------------------------------------------------
+
+template< typename Storage >
+std::vector<Storage> createStrings()
+{
+   std::vector<Storage> strings{};
+   strings.reserve( 3 );
+
+   std::string s( "A long string with 32 characters" );
+
+   if constexpr( std::is_same_v< Storage, std::string > ) {
+      // Identical to 'createStrings_1()' of 'CreateStrings.cpp', i.e. the reference of the baseline
+      strings.push_back( s );
+      strings.push_back( s + s );
+      strings.push_back( s );
+   }
+   else {
+      // The first and the third string share a single allocation
+      Storage const shared( s );
+      strings.push_back( shared );
+      strings.push_back( Storage( s + s ) );
+      strings.push_back( shared );
+   }
+
+   return strings;
+}
+
+template< typename Storage >
+static void benchmarkCreateStrings( benchmark::State& state )
+{
+   constexpr size_t N( 100000UL );
+
+   for( auto _ : state )
+   {
+      std::vector<Storage> strings{};
+
+      for( size_t i=0UL; i<N; ++i ) {
+         std::vector<Storage> tmp{};
+         tmp = createStrings<Storage>();
+         strings.push_back( tmp[0] );
+         strings.push_back( tmp[1] );
+         strings.push_back( tmp[2] );
+      }
+
+      benchmark::DoNotOptimize( strings );
+   }
+
+   state.SetItemsProcessed( 3UL * N * state.iterations() );
+}
+BENCHMARK_TEMPLATE(benchmarkCreateStrings,std::string);
+BENCHMARK_TEMPLATE(benchmarkCreateStrings,SharedString);
+BENCHMARK_TEMPLATE(benchmarkCreateStrings,LocalSharedString);
+
+
+//---- emplace_back() Benchmark -------------------------------------------------------------------
+
+// Same as the 'String' of 'MoveNoexcept.cpp', but with a configurable underlying string type and
+// a potentially throwing move, which forces 'std::vector' to copy the elements on reallocation
+template< typename Storage >
+struct String
+{
+ public:
+   String( const char* s )
+      : s_{ s }
+   {}
+
+   ~String() = default;
+   String( const String& ) = default;
+   String& operator=( const String& ) = default;
+   String( String&& ) noexcept(false) = default;
+   String& operator=( String&& ) noexcept(false) = default;
+
+ private:
+   Storage s_;
+};
+
+template< typename Storage >
+static void benchmarkEmplaceBack( benchmark::State& state )
+{
+   constexpr size_t N( 1000000 );
+
+   for( auto _ : state )
+   {
+      std::vector< String<Storage> > v;
+
+      for( size_t i=0UL; i<N; ++i ) {
+         v.emplace_back( "A long string of 30 characters" );
+      }
+
+      benchmark::DoNotOptimize( v );
+
+      // Exclude the destruction of the strings from the measurement
+      state.PauseTiming();
+      v.clear();
+      v.shrink_to_fit();
+      state.ResumeTiming();
+   }
+
+   state.SetItemsProcessed( N * state.iterations() );
+}
+BENCHMARK_TEMPLATE(benchmarkEmplaceBack,std::string);
+BENCHMARK_TEMPLATE(benchmarkEmplaceBack,SharedString);
+BENCHMARK_TEMPLATE(benchmarkEmplaceBack,LocalSharedString);
@@ -0,0 +1,130 @@
+/**************************************************************************************************
+*
+* \file StringConcat.cpp
+* \brief C++ Training - Lazy string concatenation vs. 'operator+' chains
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* Compares the concatenation of 2 to 8 strings via a chain of 'operator+' calls ('s + s + ...'),
+* which creates a temporary string per operator and repeatedly grows it, with the lazy 'concat()'
+* (see "Concat.h"), which computes the total length up front and allocates exactly once. Both the
+* creation of a new string and the appending to an existing string (e.g. a reused buffer) are
+* benchmarked:
+*
+*    StringConcat --benchmark_repetitions=1
+*
+**************************************************************************************************/
+
+#include <benchmark/benchmark.h>
+#include "Concat.h"
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+
+//---- Benchmark configuration --------------------------------------------------------------------
+
+constexpr size_t N( 100000UL );
+
+std::string const s( "A long string with 32 characters" );
+
+
+//---- Creation of a new string -------------------------------------------------------------------
+
+template< size_t Operands >
+static void benchmarkOperatorPlus( benchmark::State& state )
+{
+   for( auto _ : state )
+   {
+      for( size_t i=0UL; i<N; ++i ) {
+         std::string result( [&]<size_t... Is>( std::index_sequence<Is...> ) {
+            return ( s + ... + ( (void)Is, s ) );
+         }( std::make_index_sequence<Operands-1UL>{} ) );
+         benchmark::DoNotOptimize( result );
+      }
+   }
+
+   state.SetItemsProcessed( N * state.iterations() );
+}
+BENCHMARK_TEMPLATE(benchmarkOperatorPlus,2);
+BENCHMARK_TEMPLATE(benchmarkOperatorPlus,3);
+BENCHMARK_TEMPLATE(benchmarkOperatorPlus,4);
+BENCHMARK_TEMPLATE(benchmarkOperatorPlus,5);
+BENCHMARK_TEMPLATE(benchmarkOperatorPlus,6);
+BENCHMARK_TEMPLATE(benchmarkOperatorPlus,7);
+BENCHMARK_TEMPLATE(benchmarkOperatorPlus,8);
+
+
+template< size_t Operands >
+static void benchmarkConcat( benchmark::State& state )
+{
+   for( auto _ : state )
+   {
+      for( size_t i=0UL; i<N; ++i ) {
+         std::string result( [&]<size_t... Is>( std::index_sequence<Is...> ) {
+            return concat( ( (void)Is, s )... ).str();
+         }( std::make_index_sequence<Operands>{} ) );
+         benchmark::DoNotOptimize( result );
+      }
+   }
+
+   state.SetItemsProcessed( N * state.iterations() );
+}
+BENCHMARK_TEMPLATE(benchmarkConcat,2);
+BENCHMARK_TEMPLATE(benchmarkConcat,3);
+BENCHMARK_TEMPLATE(benchmarkConcat,4);
+BENCHMARK_TEMPLATE(benchmarkConcat,5);
+BENCHMARK_TEMPLATE(benchmarkConcat,6);
+BENCHMARK_TEMPLATE(benchmarkConcat,7);
+BENCHMARK_TEMPLATE(benchmarkConcat,8);
+
+
+//---- Appending to a reused buffer ---------------------------------------------------------------
+
+template< size_t Operands >
+static void benchmarkOperatorPlusAppend( benchmark::State& state )
+{
+   std::string buffer{};
+
+   for( auto _ : state )
+   {
+      for( size_t i=0UL; i<N; ++i ) {
+         buffer.clear();
+         buffer += [&]<size_t... Is>( std::index_sequence<Is...> ) {
+            return ( s + ... + ( (void)Is, s ) );
+         }( std::make_index_sequence<Operands-1UL>{} );
+         benchmark::DoNotOptimize( buffer );
+      }
+   }
+
+   state.SetItemsProcessed( N * state.iterations() );
+}
+BENCHMARK_TEMPLATE(benchmarkOperatorPlusAppend,2);
+BENCHMARK_TEMPLATE(benchmarkOperatorPlusAppend,4);
+BENCHMARK_TEMPLATE(benchmarkOperatorPlusAppend,8);
+
+
+template< size_t Operands >
+static void benchmarkConcatAppend( benchmark::State& state )
+{
+   std::string buffer{};
+
+   for( auto _ : state )
+   {
+      for( size_t i=0UL; i<N; ++i ) {
+         buffer.clear();
+         buffer += [&]<size_t... Is>( std::index_sequence<Is...> ) {
+            return concat( ( (void)Is, s )... );
+         }( std::make_index_sequence<Operands>{} );
+         benchmark::DoNotOptimize( buffer );
+      }
+   }
+
+   state.SetItemsProcessed( N * state.iterations() );
+}
+BENCHMARK_TEMPLATE(benchmarkConcatAppend,2);
+BENCHMARK_TEMPLATE(benchmarkConcatAppend,4);
+BENCHMARK_TEMPLATE(benchmarkConcatAppend,8);
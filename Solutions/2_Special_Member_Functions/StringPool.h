@@ -0,0 +1,203 @@
+/**************************************************************************************************
+*
+* \file StringPool.h
+* \brief C++ Training - Thread-safe interning of strings
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* A 'StringPool' stores every distinct string exactly once. 'intern()' returns an 'InternedString',
+* a pointer-sized handle to the stored string, which remains valid as long as the pool exists.
+* Since equal strings are stored only once, two handles of the same pool are equal if and only if
+* they refer to the same entry, i.e. a comparison is a single pointer comparison. The hash of the
+* string is computed once on interning and stored with the entry. In workloads dominated by
+* repeated values (e.g. the output of 'createStrings()'), a container of handles requires neither
+* an allocation nor a copy of the characters per element:
+*
+*    StringPool pool{};
+*    std::vector<InternedString> strings{};
+*    strings.push_back( pool.intern( "A long string with 32 characters" ) );
+*
+* The pool is split into shards, each protected by a 'std::shared_mutex'. Thus the lookup of an
+* existing string only acquires a shared lock, and threads interning different strings rarely
+* contend for the same lock. Entries are never removed.
+*
+**************************************************************************************************/
+
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <array>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+
+class StringPool;
+
+
+//---- <InternedString> ---------------------------------------------------------------------------
+
+class InternedString
+{
+ public:
+   // Refers to the empty string (which is equal to the empty string of every pool).
+   InternedString() noexcept
+      : entry_{ &emptyEntry }
+   {}
+
+   std::string_view view() const noexcept { return entry_->value; }
+   std::string const& str() const noexcept { return entry_->value; }
+   char const* c_str() const noexcept { return entry_->value.c_str(); }
+
+   std::size_t size() const noexcept { return entry_->value.size(); }
+   bool empty() const noexcept { return entry_->value.empty(); }
+
+   // Returns the precomputed hash of the string (equal to 'std::hash<std::string_view>').
+   std::size_t hash() const noexcept { return entry_->hash; }
+
+   operator std::string_view() const noexcept { return view(); }
+
+   // Handles of the same pool are compared by identity; handles of different pools must be
+   // compared via 'view()'.
+   friend bool operator==( InternedString lhs, InternedString rhs ) noexcept
+   {
+      return lhs.entry_ == rhs.entry_;
+   }
+
+ private:
+   friend class StringPool;
+
+   struct Entry
+   {
+      std::size_t hash{};
+      std::string value{};
+   };
+
+   explicit InternedString( Entry const* entry ) noexcept
+      : entry_{ entry }
+   {}
+
+   inline static Entry const emptyEntry{ std::hash<std::string_view>{}( std::string_view{} ), {} };
+
+   Entry const* entry_;
+};
+
+template<>
+struct std::hash<InternedString>
+{
+   std::size_t operator()( InternedString s ) const noexcept { return s.hash(); }
+};
+
+
+//---- <StringPool> -------------------------------------------------------------------------------
+
+class StringPool
+{
+ public:
+   StringPool() = default;
+
+   // The interned strings refer to the entries of the pool
+   StringPool( StringPool const& ) = delete;
+   StringPool& operator=( StringPool const& ) = delete;
+
+   // Returns the handle to the entry of the given string, which is added on first use.
+   InternedString intern( std::string_view s )
+   {
+      if( s.empty() ) return InternedString{};
+
+      Key const key{ s, std::hash<std::string_view>{}( s ) };
+      Shard& shard( shards_[key.hash % Shards] );
+
+      {
+         std::shared_lock const lock( shard.mutex );
+         if( auto const pos = shard.index.find( key ); pos != shard.index.end() ) {
+            return InternedString{ *pos };
+         }
+      }
+
+      std::unique_lock const lock( shard.mutex );
+      if( auto const pos = shard.index.find( key ); pos != shard.index.end() ) {
+         return InternedString{ *pos };  // Interned by another thread in the meantime
+      }
+      Entry const* const entry( &shard.entries.emplace_back( Entry{ key.hash, std::string( s ) } ) );
+      shard.index.insert( entry );
+      return InternedString{ entry };
+   }
+
+   // Returns the number of distinct (non-empty) strings in the pool.
+   std::size_t size() const
+   {
+      std::size_t count{};
+      for( Shard const& shard : shards_ ) {
+         std::shared_lock const lock( shard.mutex );
+         count += shard.entries.size();
+      }
+      return count;
+   }
+
+   // Returns the total number of characters of all distinct strings.
+   std::size_t characters() const
+   {
+      std::size_t count{};
+      for( Shard const& shard : shards_ ) {
+         std::shared_lock const lock( shard.mutex );
+         for( Entry const& entry : shard.entries ) {
+            count += entry.value.size();
+         }
+      }
+      return count;
+   }
+
+ private:
+   using Entry = InternedString::Entry;
+
+   static constexpr std::size_t Shards = 16UL;
+
+   // Lookup key, which allows to search for a string without creating an entry
+   struct Key
+   {
+      std::string_view value;
+      std::size_t hash;
+   };
+
+   struct Hash
+   {
+      using is_transparent = void;
+
+      std::size_t operator()( Entry const* entry ) const noexcept { return entry->hash; }
+      std::size_t operator()( Key const& key ) const noexcept { return key.hash; }
+   };
+
+   struct Equal
+   {
+      using is_transparent = void;
+
+      bool operator()( Entry const* lhs, Entry const* rhs ) const noexcept { return lhs == rhs; }
+
+      bool operator()( Key const& lhs, Entry const* rhs ) const noexcept
+      {
+         return lhs.hash == rhs->hash && lhs.value == rhs->value;
+      }
+
+      bool operator()( Entry const* lhs, Key const& rhs ) const noexcept { return (*this)( rhs, lhs ); }
+   };
+
+   struct Shard
+   {
+      mutable std::shared_mutex mutex{};
+      std::deque<Entry> entries{};  // Stable addresses on insertion
+      std::unordered_set<Entry const*,Hash,Equal> index{};
+   };
+
+   std::array<Shard,Shards> shards_{};
+};
+
+#endif
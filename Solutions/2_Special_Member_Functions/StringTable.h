@@ -0,0 +1,253 @@
+/**************************************************************************************************
+*
+* \file StringTable.h
+* \brief C++ Training - Contiguous storage of a sequence of strings
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* A 'StringTable' stores the characters of all of its strings back to back in a single growable
+* buffer plus an array of offsets. In comparison to a 'std::vector<std::string>', appending a
+* string does not require a heap allocation of its own (apart from the amortized growth of the two
+* buffers), there is no per-string 'std::string' object of 32 bytes, and a scan through all strings
+* touches contiguous memory instead of chasing a pointer per string. The strings are accessed as
+* 'std::string_view', which remain valid until the next modification of the table.
+*
+**************************************************************************************************/
+
+#ifndef STRINGTABLE_H
+#define STRINGTABLE_H
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+class StringTable
+{
+ public:
+   using size_type  = std::size_t;
+   using value_type = std::string_view;
+
+   class const_iterator;
+
+   StringTable() = default;
+
+   // Reserves memory for the given number of strings with the given total number of characters.
+   void reserve( size_type strings, size_type characters )
+   {
+      offsets_.reserve( strings + 1UL );
+      blob_.reserve( characters );
+   }
+
+   void push_back( char const* s )
+   {
+      push_back( std::string_view( s ) );
+   }
+
+   void push_back( std::string_view s )
+   {
+      // A view into the table itself would dangle after the growth of the buffer
+      if( aliases( s ) ) {
+         push_back( std::string( s ) );
+         return;
+      }
+
+      blob_.insert( blob_.end(), s.begin(), s.end() );
+      offsets_.push_back( blob_.size() );
+   }
+
+   // Appends the characters of the given string and releases its memory.
+   void push_back( std::string&& s )
+   {
+      blob_.insert( blob_.end(), s.begin(), s.end() );
+      offsets_.push_back( blob_.size() );
+      std::string{}.swap( s );
+   }
+
+   // Appends a single string consisting of the concatenation of the given parts (e.g. 's + s'),
+   // without creating a temporary string.
+   template< typename... Parts >
+      requires ( sizeof...(Parts) > 0UL ) && ( std::convertible_to< Parts const&, std::string_view > && ... )
+   void emplace_back( Parts const&... parts )
+   {
+      std::string_view const views[] = { std::string_view( parts )... };
+
+      size_type characters{};
+      for( std::string_view const view : views ) {
+         if( aliases( view ) ) {
+            push_back( ( std::string( parts ) + ... ) );
+            return;
+         }
+         characters += view.size();
+      }
+
+      reserveForAppend( 1UL, characters );
+      for( std::string_view const view : views ) {
+         blob_.insert( blob_.end(), view.begin(), view.end() );
+      }
+      offsets_.push_back( blob_.size() );
+   }
+
+   // Appends all strings of the given range (e.g. a 'std::vector<std::string>'). The buffers grow
+   // at most once for the entire range.
+   template< std::ranges::forward_range Range >
+      requires std::convertible_to< std::ranges::range_reference_t<Range>, std::string_view >
+   void append( Range const& strings )
+   {
+      size_type count{};
+      size_type characters{};
+      bool aliasing{ false };
+      for( std::string_view const s : strings ) {
+         ++count;
+         characters += s.size();
+         aliasing = aliasing || aliases( s );
+      }
+
+      // Views into the table itself would dangle after the growth of the buffer, thus the strings
+      // are copied before reserving
+      if( aliasing ) {
+         std::vector<std::string> copies{};
+         copies.reserve( count );
+         for( std::string_view const s : strings ) {
+            copies.emplace_back( s );
+         }
+         append( copies );
+         return;
+      }
+
+      reserveForAppend( count, characters );
+
+      for( std::string_view const s : strings ) {
+         push_back( s );
+      }
+   }
+
+   std::string_view operator[]( size_type index ) const noexcept
+   {
+      return std::string_view( blob_.data() + offsets_[index], offsets_[index+1UL] - offsets_[index] );
+   }
+
+   std::string_view at( size_type index ) const
+   {
+      if( index >= size() ) {
+         throw std::out_of_range( "Invalid StringTable access index" );
+      }
+      return (*this)[index];
+   }
+
+   std::string_view front() const noexcept { return (*this)[0UL]; }
+   std::string_view back() const noexcept { return (*this)[size()-1UL]; }
+
+   size_type size() const noexcept { return offsets_.size() - 1UL; }
+   bool empty() const noexcept { return size() == 0UL; }
+
+   // Returns the total number of characters of all strings.
+   size_type characters() const noexcept { return blob_.size(); }
+
+   void clear() noexcept
+   {
+      blob_.clear();
+      offsets_.resize( 1UL );
+   }
+
+   const_iterator begin() const noexcept;
+   const_iterator end() const noexcept;
+
+ private:
+   // Returns whether the given view refers to the characters of the table itself.
+   bool aliases( std::string_view s ) const noexcept
+   {
+      return !blob_.empty() && s.data() >= blob_.data() && s.data() < blob_.data() + blob_.size();
+   }
+
+   // Grows the buffers geometrically (instead of to the exact size, which would cause quadratic
+   // behavior for repeated bulk appends).
+   void reserveForAppend( size_type strings, size_type characters )
+   {
+      if( offsets_.size() + strings > offsets_.capacity() ) {
+         offsets_.reserve( std::max( offsets_.size() + strings, 2UL*offsets_.capacity() ) );
+      }
+      if( blob_.size() + characters > blob_.capacity() ) {
+         blob_.reserve( std::max( blob_.size() + characters, 2UL*blob_.capacity() ) );
+      }
+   }
+
+   std::vector<char> blob_{};
+   std::vector<size_type> offsets_{ 0UL };  // Offset of the begin of each string plus the end
+};
+
+
+//---- <StringTable::const_iterator> --------------------------------------------------------------
+
+class StringTable::const_iterator
+{
+ public:
+   using iterator_concept  = std::random_access_iterator_tag;
+   using iterator_category = std::random_access_iterator_tag;
+   using value_type        = std::string_view;
+   using difference_type   = std::ptrdiff_t;
+   using reference         = std::string_view;
+   using pointer           = void;
+
+   const_iterator() = default;
+
+   const_iterator( StringTable const* table, size_type index ) noexcept
+      : table_{ table }
+      , index_{ index }
+   {}
+
+   std::string_view operator*() const noexcept { return (*table_)[index_]; }
+   std::string_view operator[]( difference_type n ) const noexcept { return (*table_)[index_+n]; }
+
+   const_iterator& operator++() noexcept { ++index_; return *this; }
+   const_iterator& operator--() noexcept { --index_; return *this; }
+   const_iterator operator++( int ) noexcept { auto tmp( *this ); ++index_; return tmp; }
+   const_iterator operator--( int ) noexcept { auto tmp( *this ); --index_; return tmp; }
+
+   const_iterator& operator+=( difference_type n ) noexcept { index_ += n; return *this; }
+   const_iterator& operator-=( difference_type n ) noexcept { index_ -= n; return *this; }
+
+   friend const_iterator operator+( const_iterator it, difference_type n ) noexcept { return it += n; }
+   friend const_iterator operator+( difference_type n, const_iterator it ) noexcept { return it += n; }
+   friend const_iterator operator-( const_iterator it, difference_type n ) noexcept { return it -= n; }
+
+   friend difference_type operator-( const_iterator const& lhs, const_iterator const& rhs ) noexcept
+   {
+      return static_cast<difference_type>( lhs.index_ ) - static_cast<difference_type>( rhs.index_ );
+   }
+
+   friend bool operator==( const_iterator const& lhs, const_iterator const& rhs ) noexcept
+   {
+      return lhs.index_ == rhs.index_;
+   }
+
+   friend auto operator<=>( const_iterator const& lhs, const_iterator const& rhs ) noexcept
+   {
+      return lhs.index_ <=> rhs.index_;
+   }
+
+ private:
+   StringTable const* table_{ nullptr };
+   size_type index_{};
+};
+
+inline StringTable::const_iterator StringTable::begin() const noexcept
+{
+   return const_iterator( this, 0UL );
+}
+
+inline StringTable::const_iterator StringTable::end() const noexcept
+{
+   return const_iterator( this, size() );
+}
+
+#endif
@@ -0,0 +1,122 @@
+/**************************************************************************************************
+*
+* \file StringTable_Test.cpp
+* \brief C++ Training - Tests for the StringTable
+*
+* Copyright (C) 2015-2024 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+* Checks the content of a 'StringTable' (see "StringTable.h") after appending strings, with an
+* emphasis on appending views that refer to the table itself, which must be copied before the
+* buffer grows. The test is registered via ctest ('ctest -R StringTable').
+*
+**************************************************************************************************/
+
+#include "StringTable.h"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+//---- Test cases ---------------------------------------------------------------------------------
+
+bool contains( StringTable const& table, std::vector<std::string_view> const& expected )
+{
+   if( table.size() != expected.size() ) return false;
+
+   for( std::size_t i=0UL; i<expected.size(); ++i ) {
+      if( table[i] != expected[i] ) return false;
+   }
+   return true;
+}
+
+bool pushBack()
+{
+   StringTable table{};
+   table.push_back( "hello" );
+   table.push_back( std::string_view( "" ) );
+   table.push_back( std::string( "world" ) );
+   return contains( table, { "hello", "", "world" } ) && table.characters() == 10UL;
+}
+
+bool pushBackAliasing()
+{
+   StringTable table{};
+   table.push_back( "hello" );
+   for( int i=0; i<10; ++i ) {
+      table.push_back( table.back() );
+   }
+   return table.size() == 11UL && table.back() == "hello";
+}
+
+bool emplaceBackAliasing()
+{
+   StringTable table{};
+   table.push_back( "hello" );
+   table.emplace_back( table[0], std::string_view( " " ), table[0] );
+   return contains( table, { "hello", "hello hello" } );
+}
+
+bool append()
+{
+   StringTable table{};
+   table.push_back( "a" );
+   table.append( std::vector<std::string>{ "bc", "def" } );
+   return contains( table, { "a", "bc", "def" } );
+}
+
+// Views into the table must stay valid even though the buffer grows during the append
+bool appendAliasing()
+{
+   StringTable table{};
+   table.push_back( "hello" );
+   std::vector<std::string_view> const views{ table[0], table[0] };
+   table.append( views );
+   return contains( table, { "hello", "hello", "hello" } );
+}
+
+bool appendItself()
+{
+   StringTable table{};
+   table.push_back( "hello" );
+   table.push_back( "world" );
+   table.append( table );
+   return contains( table, { "hello", "world", "hello", "world" } );
+}
+
+
+//---- Test driver --------------------------------------------------------------------------------
+
+struct Test
+{
+   char const* name;
+   bool (*run)();
+};
+
+constexpr Test tests[] = {
+   { "push_back()"                , pushBack            },
+   { "push_back() of itself"      , pushBackAliasing    },
+   { "emplace_back() of itself"   , emplaceBackAliasing },
+   { "append()"                   , append              },
+   { "append() of views into it"  , appendAliasing      },
+   { "append() of itself"         , appendItself        },
+};
+
+
+int main()
+{
+   int failures{};
+
+   for( auto const& test : tests )
+   {
+      bool const passed( test.run() );
+      std::cout << ( passed ? "[ PASSED ] " : "[ FAILED ] " ) << test.name << "\n";
+      if( !passed ) ++failures;
+   }
+
+   return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -8,8 +8,9 @@
 * This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
 * context of the C++ training or with explicit agreement by Klaus Iglberger.
 *
-* Step 1: Copy-and-paste the following code into 'quick-bench.com'. Benchmark the given code
-*         example to create a performance base line.
+* Step 1: Benchmark the given code example to create a performance base line. Either build and
+*         run the 'CreateStrings' target or copy-and-paste the following code into
+*         'quick-bench.com'.
 *
 * Step 2: Improve the performance of the given code by refactoring. After each modification, first
 *         predict how performance is affected and then benchmark the actual effect. Explain why
@@ -18,9 +19,8 @@
 *
 **************************************************************************************************/
 
-#include <chrono>
+#include <benchmark/benchmark.h>
 #include <cstdlib>
-#include <iostream>
 #include <string>
 #include <vector>
 
@@ -60,6 +60,8 @@ static void benchmarkBaseline( benchmark::State& state )
          strings.push_back( tmp[2] );
       }
    }
+
+   state.SetItemsProcessed( 3UL * N * state.iterations() );
 }
 BENCHMARK(benchmarkBaseline);
 
@@ -80,7 +82,7 @@ std::vector<std::string> createStrings_2()
    return strings;
 }
 
-static void benchmarkOptimization( benchmark::State& state )
+[[maybe_unused]] static void benchmarkOptimization( benchmark::State& state )
 {
    for( auto _ : state )
    {
@@ -94,6 +96,8 @@ static void benchmarkOptimization( benchmark::State& state )
          strings.push_back( tmp[2] );
       }
    }
+
+   state.SetItemsProcessed( 3UL * N * state.iterations() );
 }
 //BENCHMARK(benchmarkOptimization);
 
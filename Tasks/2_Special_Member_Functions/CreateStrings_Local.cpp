@@ -15,12 +15,34 @@
 *         performance was affected accordingly. Note that we assume that the 'createStrings()'
 *         function does not produce a predictable result!
 *
+*         Compare the results on a warm cache ('/cache:warm') with the results on a cold cache
+*         ('/cache:cold'), where the last-level cache is evicted before every run. The latency
+*         distribution of the individual 'createStrings()' calls is reported by running:
+*
+*            CreateStrings_Local --benchmark_filter=Latency
+*
+* Step 3: Analyze how the effect of your optimizations depends on the number of strings and on the
+*         string length (below and above the small string optimization (SSO) buffer size) by
+*         running the parameter sweep:
+*
+*            CreateStrings_Local --benchmark_filter=Sweep --benchmark_repetitions=1 \
+*                                --benchmark_format=csv
+*
+* Step 4: Analyze how well the 'createStrings()' loop scales with the number of threads (each
+*         thread fills its own result vector) by running the threaded variant:
+*
+*            CreateStrings_Local --benchmark_filter=threads:
+*
+*         Which effect do the memory allocations have on the per-thread throughput and on the
+*         scaling efficiency? How does this change after your optimizations?
+*
 **************************************************************************************************/
 
-#include <chrono>
+#include <benchmark/benchmark.h>
+#include <algorithm>
 #include <cstdlib>
-#include <iostream>
 #include <string>
+#include <thread>
 #include <vector>
 
 
@@ -39,29 +61,109 @@ std::vector<std::string> createStrings()
 }
 
 
-int main()
+static void benchmarkCreateStrings( benchmark::State& state )
 {
    const size_t N( 100000UL );
 
-   std::vector<std::string> strings{};
+   for( auto _ : state )
+   {
+      std::vector<std::string> strings{};
+
+      for( size_t i=0UL; i<N; ++i ) {
+         std::vector<std::string> tmp{};
+         tmp = createStrings();
+         strings.push_back( tmp[0] );
+         strings.push_back( tmp[1] );
+         strings.push_back( tmp[2] );
+      }
+
+      benchmark::DoNotOptimize( strings );
+   }
+
+   state.SetItemsProcessed( 3UL * N * state.iterations() );
+}
+BENCHMARK(benchmarkCreateStrings)->CacheModes();
+
+
+// Same as 'benchmarkCreateStrings()', but records the latency distribution of the individual
+// 'createStrings()' calls
+static void benchmarkCreateStringsLatency( benchmark::State& state )
+{
+   const size_t N( 100000UL );
+
+   for( auto _ : state )
+   {
+      std::vector<std::string> strings{};
 
-   std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
-   start = std::chrono::high_resolution_clock::now();
+      for( size_t i=0UL; i<N; ++i ) {
+         std::vector<std::string> tmp{};
+         state.MeasureLatency( [&]{ tmp = createStrings(); } );
+         strings.push_back( tmp[0] );
+         strings.push_back( tmp[1] );
+         strings.push_back( tmp[2] );
+      }
 
-   for( size_t i=0UL; i<N; ++i ) {
-      std::vector<std::string> tmp{};
-      tmp = createStrings();
-      strings.push_back( tmp[0] );
-      strings.push_back( tmp[1] );
-      strings.push_back( tmp[2] );
+      benchmark::DoNotOptimize( strings );
    }
 
-   end = std::chrono::high_resolution_clock::now();
-   const std::chrono::duration<double> elapsedTime( end - start );
-   const double seconds( elapsedTime.count() );
+   state.SetItemsProcessed( 3UL * N * state.iterations() );
+}
+BENCHMARK(benchmarkCreateStringsLatency)->ExplicitOnly();
+
 
-   std::cout << " Runtime: " << seconds << "s\n\n";
+//---- Parameter sweep ----------------------------------------------------------------------------
 
-   return EXIT_SUCCESS;
+// Same as 'createStrings()', but with a configurable string length
+std::vector<std::string> createStrings( size_t length )
+{
+   std::vector<std::string> strings{};
+   strings.reserve( 3 );
+
+   std::string s( length, 'A' );
+
+   strings.push_back( s );
+   strings.push_back( s + s );
+   strings.push_back( s );
+
+   return strings;
 }
 
+static void benchmarkCreateStringsSweep( benchmark::State& state )
+{
+   const size_t N( state.range(0) );
+   const size_t length( state.range(1) );
+
+   for( auto _ : state )
+   {
+      std::vector<std::string> strings{};
+
+      for( size_t i=0UL; i<N; ++i ) {
+         std::vector<std::string> tmp{};
+         tmp = createStrings( length );
+         strings.push_back( tmp[0] );
+         strings.push_back( tmp[1] );
+         strings.push_back( tmp[2] );
+      }
+
+      benchmark::DoNotOptimize( strings );
+   }
+
+   state.SetItemsProcessed( 3UL * N * state.iterations() );
+}
+BENCHMARK(benchmarkCreateStringsSweep)
+   ->ArgNames( { "N", "length" } )
+   // The long strings are limited to smaller N to keep the memory consumption below ~0.5 GB
+   ->ArgsProduct( { benchmark::CreateRange( 100, 100000, 10 ),
+                    { 0, 8, 15, 16, 24, 32, 64, 128, 256 } } )
+   ->ArgsProduct( { { 1000000 },
+                    { 0, 8, 15, 16, 24, 32, 64 } } )
+   ->ExplicitOnly();
+
+
+//---- Multi-threaded scaling ---------------------------------------------------------------------
+
+// Runs the 'createStrings()' loop concurrently on several threads. Every thread performs the full
+// amount of work on its own result vector, so ideally the time stays constant ('efficiency=1').
+BENCHMARK(benchmarkCreateStrings)
+   ->ThreadRange( 1, static_cast<int>( std::max( std::thread::hardware_concurrency(), 1U ) ) )
+   ->ExplicitOnly();
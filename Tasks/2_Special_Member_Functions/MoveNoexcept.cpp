@@ -9,15 +9,46 @@
 * context of the C++ training or with explicit agreement by Klaus Iglberger.
 *
 * Task: Examine the influence of declaring the move operations 'noexcept' by means of creating
-*       a 'std::vector' of strings.
+*       a 'std::vector' of strings. Analyze how the effect depends on the number of strings and
+*       on the string length (below and above the small string optimization (SSO) buffer size) by
+*       running the parameter sweep:
+*
+*          MoveNoexcept --benchmark_filter=Sweep --benchmark_repetitions=1 --benchmark_format=csv
+*
+*       Also compare the memory cost: 'heap-peak' reports the maximum number of simultaneously
+*       allocated bytes, 'RSS-peak' the peak resident set size of the process. Finally, compare
+*       the results on a warm cache ('/cache:warm') with the results on a cold cache ('/cache:cold').
+*
+*       The latency distribution of the individual 'emplace_back()' calls (including the spikes
+*       caused by the reallocations) can be examined by running:
+*
+*          MoveNoexcept --benchmark_filter=Latency
+*
+*       The state of the heap after growing the vector step by step ('benchmarkEmplaceBack') and
+*       after reserving the required capacity up front ('benchmarkEmplaceBackReserve') can be
+*       compared by running:
+*
+*          MoveNoexcept --benchmark_filter=EmplaceBack --benchmark_heap_stats=true
+*
+*       'heap-frag' reports the fraction of the heap that is free but trapped between allocated
+*       chunks (i.e. cannot be returned to the system), 'free-chunks' the number of free chunks.
+*
+*       Finally, compare the runtime, the number of copies and moves per element, the number of
+*       allocations and the peak memory of all combinations of a string with a noexcept move, a
+*       potentially throwing move, a move-only and a copy-only string with and without reserving
+*       the capacity, in a 'std::vector' and in a 'std::deque':
+*
+*          MoveNoexcept --benchmark_filter=Matrix --benchmark_repetitions=1
 *
 **************************************************************************************************/
 
+#include <benchmark/benchmark.h>
+#include <benchmark/traced.h>
 #include <algorithm>
-#include <chrono>
 #include <cstdlib>
-#include <iostream>
+#include <deque>
 #include <string>
+#include <utility>
 #include <vector>
 
 
@@ -45,25 +76,196 @@ struct String
 };
 
 
-int main()
+static void benchmarkEmplaceBack( benchmark::State& state )
+{
+   constexpr size_t N( 5000000 );
+
+   for( auto _ : state )
+   {
+      std::vector<String> v;
+
+      for( size_t i=0UL; i<N; ++i ) {
+         v.emplace_back( "A long string of 30 characters" );
+      }
+
+      benchmark::DoNotOptimize( v );
+
+      // Exclude the destruction of the strings from the measurement
+      state.PauseTiming();
+      state.RecordHeapStatistics();
+      v.clear();
+      v.shrink_to_fit();
+      state.ResumeTiming();
+   }
+
+   state.SetItemsProcessed( N * state.iterations() );
+}
+BENCHMARK(benchmarkEmplaceBack)->CacheModes();
+
+
+static void benchmarkEmplaceBackReserve( benchmark::State& state )
+{
+   constexpr size_t N( 5000000 );
+
+   for( auto _ : state )
+   {
+      std::vector<String> v;
+      v.reserve( N );
+
+      for( size_t i=0UL; i<N; ++i ) {
+         v.emplace_back( "A long string of 30 characters" );
+      }
+
+      benchmark::DoNotOptimize( v );
+
+      // Exclude the destruction of the strings from the measurement
+      state.PauseTiming();
+      state.RecordHeapStatistics();
+      v.clear();
+      v.shrink_to_fit();
+      state.ResumeTiming();
+   }
+
+   state.SetItemsProcessed( N * state.iterations() );
+}
+BENCHMARK(benchmarkEmplaceBackReserve);
+
+
+static void benchmarkEmplaceBackLatency( benchmark::State& state )
 {
    constexpr size_t N( 5000000 );
 
-   std::vector<String> v;
+   for( auto _ : state )
+   {
+      std::vector<String> v;
+
+      for( size_t i=0UL; i<N; ++i ) {
+         state.MeasureLatency( [&]{ v.emplace_back( "A long string of 30 characters" ); } );
+      }
 
-   std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
-   start = std::chrono::high_resolution_clock::now();
+      benchmark::DoNotOptimize( v );
 
-   for( size_t i=0UL; i<N; ++i ) {
-      v.emplace_back( "A long string of 30 characters" );
+      // Exclude the destruction of the strings from the measurement
+      state.PauseTiming();
+      v.clear();
+      v.shrink_to_fit();
+      state.ResumeTiming();
    }
 
-   end = std::chrono::high_resolution_clock::now();
-   const std::chrono::duration<double> elapsedTime( end - start );
-   const double seconds( elapsedTime.count() );
+   state.SetItemsProcessed( N * state.iterations() );
+}
+BENCHMARK(benchmarkEmplaceBackLatency)->ExplicitOnly();
+
+
+static void benchmarkEmplaceBackSweep( benchmark::State& state )
+{
+   const size_t N( state.range(0) );
+   const std::string s( state.range(1), 'A' );
 
-   std::cout << " Runtime: " << seconds << "s\n\n";
+   for( auto _ : state )
+   {
+      std::vector<String> v;
+
+      for( size_t i=0UL; i<N; ++i ) {
+         v.emplace_back( s );
+      }
+
+      benchmark::DoNotOptimize( v );
+
+      // Exclude the destruction of the strings from the measurement
+      state.PauseTiming();
+      v.clear();
+      v.shrink_to_fit();
+      state.ResumeTiming();
+   }
 
-   return EXIT_SUCCESS;
+   state.SetItemsProcessed( N * state.iterations() );
 }
+BENCHMARK(benchmarkEmplaceBackSweep)
+   ->ArgNames( { "N", "length" } )
+   // The long strings are limited to smaller N to keep the memory consumption below ~0.5 GB
+   ->ArgsProduct( { benchmark::CreateRange( 100, 100000, 10 ),
+                    { 0, 8, 15, 16, 24, 30, 64, 128, 256 } } )
+   ->ArgsProduct( { { 1000000 },
+                    { 0, 8, 15, 16, 24, 30, 64 } } )
+   ->ExplicitOnly();
+
+
+//---- Comparison matrix --------------------------------------------------------------------------
+
+// The copies and moves of all strings are counted via the 'Traced' data member, which allows
+// the implicitly generated copy and move operations to be used (see <benchmark/traced.h>).
+template< bool Copyable, bool Movable, bool NoexceptMove >
+struct BasicString
+{
+ public:
+   BasicString( const char* s )
+      : s_{ s }
+   {}
+
+   ~BasicString() = default;
+   BasicString( const BasicString& ) requires Copyable = default;
+   BasicString& operator=( const BasicString& ) requires Copyable = default;
+   BasicString( BasicString&& ) noexcept(NoexceptMove) requires Movable = default;
+   BasicString& operator=( BasicString&& ) noexcept(NoexceptMove) requires Movable = default;
 
+ private:
+   benchmark::Traced<std::string> s_;
+};
+
+using NoexceptMove = BasicString<true,true,true>;
+using ThrowingMove = BasicString<true,true,false>;
+using MoveOnly     = BasicString<false,true,false>;  // Moved despite the potentially throwing move
+using CopyOnly     = BasicString<true,false,false>;  // Copied since there is no move constructor
+
+constexpr bool reserve( true );
+constexpr bool grow( false );
+
+
+template< typename Element, template< typename... > class Container, bool Reserve >
+static void benchmarkMatrix( benchmark::State& state )
+{
+   constexpr size_t N( 1000000 );
+
+   using Traced = benchmark::Traced<std::string>;
+   Traced::reset();
+
+   for( auto _ : state )
+   {
+      Container<Element> c;
+      if constexpr( Reserve ) {
+         c.reserve( N );
+      }
+
+      for( size_t i=0UL; i<N; ++i ) {
+         c.emplace_back( "A long string of 30 characters" );
+      }
+
+      benchmark::DoNotOptimize( c );
+
+      // Exclude the destruction of the strings from the measurement
+      state.PauseTiming();
+      c.clear();
+      c.shrink_to_fit();
+      state.ResumeTiming();
+   }
+
+   benchmark::TracedCounts const counts( Traced::counts() );
+   double const elements( static_cast<double>( N * state.iterations() ) );
+   state.counters["copies/elem"] = static_cast<double>( counts.copies() ) / elements;
+   state.counters["moves/elem"]  = static_cast<double>( counts.moves()  ) / elements;
+
+   state.SetItemsProcessed( N * state.iterations() );
+}
+BENCHMARK_TEMPLATE(benchmarkMatrix,NoexceptMove,std::vector,grow)->ExplicitOnly();
+BENCHMARK_TEMPLATE(benchmarkMatrix,ThrowingMove,std::vector,grow)->ExplicitOnly();
+BENCHMARK_TEMPLATE(benchmarkMatrix,MoveOnly,std::vector,grow)->ExplicitOnly();
+BENCHMARK_TEMPLATE(benchmarkMatrix,CopyOnly,std::vector,grow)->ExplicitOnly();
+BENCHMARK_TEMPLATE(benchmarkMatrix,NoexceptMove,std::vector,reserve)->ExplicitOnly();
+BENCHMARK_TEMPLATE(benchmarkMatrix,ThrowingMove,std::vector,reserve)->ExplicitOnly();
+BENCHMARK_TEMPLATE(benchmarkMatrix,MoveOnly,std::vector,reserve)->ExplicitOnly();
+BENCHMARK_TEMPLATE(benchmarkMatrix,CopyOnly,std::vector,reserve)->ExplicitOnly();
+BENCHMARK_TEMPLATE(benchmarkMatrix,NoexceptMove,std::deque,grow)->ExplicitOnly();
+BENCHMARK_TEMPLATE(benchmarkMatrix,ThrowingMove,std::deque,grow)->ExplicitOnly();
+BENCHMARK_TEMPLATE(benchmarkMatrix,MoveOnly,std::deque,grow)->ExplicitOnly();
+BENCHMARK_TEMPLATE(benchmarkMatrix,CopyOnly,std::deque,grow)->ExplicitOnly();
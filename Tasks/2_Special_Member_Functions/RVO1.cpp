@@ -13,6 +13,12 @@
 *       2) ... creating an instance of 'S' via the copy constructor;
 *       3) ... creating an instance of 'S' via a function returning an 'S'.
 *
+* Tip: For larger scenarios, record all special member function calls in a trace file and open
+*      it in 'chrome://tracing' or 'ui.perfetto.dev'. The traced build 'RVO1_Trace' runs this
+*      program unchanged (see <benchmark/trace_puts.h>):
+*
+*         BENCHMARK_TRACE=RVO1.json ./RVO1_Trace
+*
 **************************************************************************************************/
 
 #include <cstdio>
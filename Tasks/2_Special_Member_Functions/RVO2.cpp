@@ -10,6 +10,12 @@
 *
 * Task: Estimate the number of special member function calls in the following two code examples.
 *
+* Tip: For larger scenarios, record all special member function calls in a trace file and open
+*      it in 'chrome://tracing' or 'ui.perfetto.dev'. The traced build 'RVO2_Trace' runs this
+*      program unchanged (see <benchmark/trace_puts.h>):
+*
+*         BENCHMARK_TRACE=RVO2.json ./RVO2_Trace
+*
 **************************************************************************************************/
 
 #include <cstdio>
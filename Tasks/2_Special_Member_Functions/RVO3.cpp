@@ -10,6 +10,12 @@
 *
 * Task: Evaluate the given code examples. Will the functions apply copy elision (aka RVO)?
 *
+* Tip: For larger scenarios, record all special member function calls in a trace file and open
+*      it in 'chrome://tracing' or 'ui.perfetto.dev'. The traced build 'RVO3_Trace' runs this
+*      program unchanged (see <benchmark/trace_puts.h>):
+*
+*         BENCHMARK_TRACE=RVO3.json ./RVO3_Trace
+*
 **************************************************************************************************/
 
 #include <cstdio>